@@ -0,0 +1,49 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        Animation.cpp
+//
+// Author:      David Borland
+//
+// Description: Time-based animation curves.  Each takes the elapsed time, so the result 
+//              after a given amount of time doesn't depend on how it was divided into steps.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "Animation.h"
+
+#include <math.h>
+
+
+float Animation::Exponential(float value, float target, float rate, double seconds) {
+    float t = (float)(1.0 - exp(-rate * seconds));
+
+    return value + (target - value) * t;
+}
+
+Vec2 Animation::Exponential(const Vec2& value, const Vec2& target, float rate, double seconds) {
+    float t = (float)(1.0 - exp(-rate * seconds));
+
+    return value + (target - value) * t;
+}
+
+
+float Animation::Linear(float value, float target, float speed, double seconds) {
+    float step = (float)(speed * seconds);
+
+    if (value < target) {
+        value += step;
+        if (value > target) value = target;
+    }
+    else if (value > target) {
+        value -= step;
+        if (value < target) value = target;
+    }
+
+    return value;
+}
+
+
+float Animation::ExponentialRate(float fractionPerStep, double stepSeconds) {
+    return (float)(-log(1.0 - fractionPerStep) / stepSeconds);
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        Animation.h
+//
+// Author:      David Borland
+//
+// Description: Time-based animation curves.  Each takes the elapsed time, so the result 
+//              after a given amount of time doesn't depend on how it was divided into steps.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef ANIMATION_H
+#define ANIMATION_H
+
+
+#include <Vec2.h>
+
+
+class Animation {
+public:
+    // Moves value toward target, covering the fraction 1 - exp(-rate * seconds) of the 
+    // remaining distance
+    static float Exponential(float value, float target, float rate, double seconds);
+    static Vec2 Exponential(const Vec2& value, const Vec2& target, float rate, double seconds);
+
+    // Moves value toward target at speed units per second, stopping at target
+    static float Linear(float value, float target, float speed, double seconds);
+
+    // The exponential rate that covers the given fraction of the distance every step
+    static float ExponentialRate(float fractionPerStep, double stepSeconds);
+};
+
+
+#endif
\ No newline at end of file
@@ -1,246 +1,570 @@
-///////////////////////////////////////////////////////////////////////////////////////////////
-//
-// Name:        Azrael.cpp
-//
-// Author:      David Borland
-//
-// Description: wxWidgets code for Azrael, a media installation developed with RENCI Faculty
-//              Fellow Joyce Rudinsky for deployment in the Social Computing Room.
-//
-///////////////////////////////////////////////////////////////////////////////////////////////
-
-
-#include "Azrael.h"
-
-#include <wx/textctrl.h>
-
-#include <string>
-
-
-/////////////////////////////////////////////////////////////////////////////////////////////
-// Azrael
-/////////////////////////////////////////////////////////////////////////////////////////////
-
-
-IMPLEMENT_APP(Azrael)
-
-
-bool Azrael::OnInit() {
-    // Create the main frame window
-    AzraelFrame* frame = new AzraelFrame("Azrael", wxSize(12288, 768));
-//AzraelFrame* frame = new AzraelFrame("Azrael", wxSize(3840, (float)(3840 * 768) / (float)12288));
-
-    // Show it.  Frames, unlike simple controls, are not shown initially when created.
-    frame->Show();
-
-    // Tell wxWidgets that this is a main frame
-    SetTopWindow(frame);
-
-    // Check initialization
-    if (!frame->Initialize()) {
-        wxLogMessage("Initialization failed.  Exiting...");
-//        return false;
-    }
-
-    // Success:  wxApp::OnRun() will be called which will enter the main message
-    // loop and the application will run. If we returned false here, the
-    // application would exit immediately.
-    return true;
-}
-
-
-/////////////////////////////////////////////////////////////////////////////////////////////
-// AzraelFrame
-/////////////////////////////////////////////////////////////////////////////////////////////
-
-
-BEGIN_EVENT_TABLE(AzraelFrame, wxFrame)
-    EVT_TIMER(RenderTimerId, AzraelFrame::OnTimer)
-    EVT_TIMER(TriggerTimerId, AzraelFrame::OnTimer)
-    EVT_TIMER(StateTimerId, AzraelFrame::OnTimer)
-    EVT_TIMER(ViolenceTimerId, AzraelFrame::OnTimer)
-END_EVENT_TABLE()
-
-
-AzraelFrame::AzraelFrame(const wxString& title, const wxSize& size) 
-: wxFrame((wxFrame*) NULL, wxID_ANY, title, wxPoint(0, 0), size, wxBORDER_NONE | wxSYSTEM_MENU) {
-    // Create a log window for printing messages
-    log = new wxLogWindow(this, "Log Window", true, false);
-
-    // Not sure how to completely hide the cursor, but this makes it a single black pixel
-    SetCursor(wxImage(1, 1));
-
-    // Set the OpenGL attributes for the canvases
-    int attribList[] = { WX_GL_RGBA,
-                         WX_GL_DOUBLEBUFFER,
-                         0 };
-
-/*
-text = new wxTextCtrl(this, wxID_ANY, "", wxPoint(0, 0), wxSize(size.GetX() / 2, size.GetY() / 2));
-redirect = new wxStreamToTextRedirector(text);
-*/
-
-    // Create two OpenGL canvases
-    int width = size.GetWidth() / 2;
-    int height = size.GetHeight();
-    canvas1 = new AzraelGLCanvas(this, attribList, wxPoint(0, 0), wxSize(width, height));
-    canvas2 = new AzraelGLCanvas(this, attribList, wxPoint(width, 0), wxSize(width, height));
-
-
-    context = new wxGLContext(canvas1);
-    
-
-    // Create a timer for rendering
-    renderTimer = new wxTimer(this, RenderTimerId);
-
-    // Create a timer for triggering events
-    triggerTimer = new wxTimer(this, TriggerTimerId);
-
-    // Create a timer for triggering changes in state
-    stateTimer = new wxTimer(this, StateTimerId);  
-
-    // Createa a timer for loading a violent image
-    violenceTimer = new wxTimer(this, ViolenceTimerId);
-
-
-    // Seed the random number generator
-    srand(time(NULL));
-
-
-    // Create the engine
-    engine = new Engine();
-}
-
-AzraelFrame::~AzraelFrame() {
-    delete engine;
-    delete context;
-}
-
-
-bool AzraelFrame::Initialize() { 
-    context->SetCurrent(*canvas1);
-
-    int width, height;
-    GetClientSize(&width, &height);
-    if (!engine->Initialize((HWND)this->GetHandle(), width, height)) {
-        wxLogMessage("Engine::Initialize() : Engine initialization failed.");
-        return false;
-    }
-
-    renderTimer->Start(10);
-    triggerTimer->Start(20 * 1000);
-
-    int minStart = 8 * 60;
-    int maxStart = 12 * 60;
-    int start = minStart + rand() % (maxStart - minStart);
-    stateTimer->Start(start * 1000, wxTIMER_ONE_SHOT);
-//stateTimer->Start(30 * 1000, wxTIMER_ONE_SHOT);
-
-    // Flip a coin for violence
-    if (rand() % 2 == 0) {
-        violenceTimer->Start((rand() % start) * 1000, wxTIMER_ONE_SHOT);
-    }
-//    violenceTimer->Start(30 * 1000, wxTIMER_ONE_SHOT);
-
-    return true;
-}
-
-
-void AzraelFrame::OnTimer(wxTimerEvent& e) {
-    if (e.GetId() == RenderTimerId) {
-        context->SetCurrent(*canvas1);
-
-        engine->Update();
-
-        Render();
-    }
-    else if (e.GetId() == TriggerTimerId) {
-        engine->Trigger();
-    }
-    else if (e.GetId() == StateTimerId) {
-        if (engine->GetState() == Engine::Normal) {
-            engine->Victimize();
-
-            stateTimer->Start(60 * 1000, wxTIMER_ONE_SHOT);
-//stateTimer->Start(10 * 1000, wxTIMER_ONE_SHOT);
-        }
-        else if (engine->GetState() == Engine::Victimizing) {
-            engine->CoolDown1();
-
-            stateTimer->Start(10 * 1000, wxTIMER_ONE_SHOT);
-//stateTimer->Start(10 * 1000, wxTIMER_ONE_SHOT);
-        }
-        else if (engine->GetState() == Engine::CoolingDown1) {
-            engine->CoolDown2();
-
-            stateTimer->Start(20 * 1000, wxTIMER_ONE_SHOT);
-//stateTimer->Start(10 * 1000, wxTIMER_ONE_SHOT);
-        }
-        else if (engine->GetState() == Engine::CoolingDown2) {
-            engine->Reset();
-
-            int minStart = 8 * 60;
-            int maxStart = 12 * 60;
-            int start = minStart + rand() % (maxStart - minStart);
-            stateTimer->Start(start * 1000, wxTIMER_ONE_SHOT);
-//stateTimer->Start(30 * 1000);
-
-            // Flip a coin for violence
-            if (rand() % 2 == 0) {
-                violenceTimer->Start((rand() % start) * 1000, wxTIMER_ONE_SHOT);
-            }
-        }
-    }
-    else if (e.GetId() == ViolenceTimerId) {
-        engine->DoViolence();
-                
-        // Apparently, the oneShot parameter does nothing, so stop it here
-        violenceTimer->Stop();
-    }
-}
-
-
-void AzraelFrame::Render() {
-    context->SetCurrent(*canvas1);
-    engine->RenderLeft();
-
-    context->SetCurrent(*canvas2);
-    engine->RenderRight();
-
-    // XXX : Is this is the cause of the slow down/jumpiness...
-    canvas1->SwapBuffers();
-    canvas2->SwapBuffers();
-}
-
-/////////////////////////////////////////////////////////////////////////////////////////////
-// AzraelGLCanvas
-/////////////////////////////////////////////////////////////////////////////////////////////
-
-
-BEGIN_EVENT_TABLE(AzraelGLCanvas, wxGLCanvas)
-    EVT_PAINT(AzraelGLCanvas::OnPaint)
-    EVT_ERASE_BACKGROUND(AzraelGLCanvas::OnEraseBackground)
-    EVT_CHAR(AzraelGLCanvas::OnKey)
-END_EVENT_TABLE()
-
-
-AzraelGLCanvas::AzraelGLCanvas(wxWindow* parent, int* attribList, const wxPoint& pos, const wxSize& size)
-: wxGLCanvas(parent, wxID_ANY, attribList, pos, size) {
-}
-
-
-void AzraelGLCanvas::OnPaint(wxPaintEvent& WXUNUSED(e)) { 
-    wxPaintDC(this);
-}
-
-void AzraelGLCanvas::OnEraseBackground(wxEraseEvent& WXUNUSED(e)) {
-    // Do nothing, to avoid flashing.
-}
-
-void AzraelGLCanvas::OnKey(wxKeyEvent& e) {
-    int c = e.GetKeyCode();
-    if (c == 'q') {
-        // Quit
-        exit(0);
-    }
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        Azrael.cpp
+//
+// Author:      David Borland
+//
+// Description: wxWidgets code for Azrael, a media installation developed with RENCI Faculty
+//              Fellow Joyce Rudinsky for deployment in the Social Computing Room.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "Azrael.h"
+
+#include "Random.h"
+#include "Benchmark.h"
+#include "TrackerLogger.h"
+#include "SessionAnalyzer.h"
+#include "Profiler.h"
+#include "FrameCache.h"
+
+#include <wx/textctrl.h>
+#include <wx/cmdline.h>
+
+#include <string>
+#include <time.h>
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// AzraelOptions
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+
+AzraelOptions::AzraelOptions() {
+    replaySpeed = 1;
+    seed = (unsigned int)time(NULL);
+    headless = false;
+    pyramidBlur = false;
+    frameCache = false;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Azrael
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+
+IMPLEMENT_APP(Azrael)
+
+
+bool Azrael::OnInit() {
+    // Get the command line options
+    AzraelOptions options;
+    if (!ParseCommandLine(options)) return false;
+
+    if (options.benchmarkFileName != "") {
+        Benchmark benchmark;
+        benchmark.Run(options.benchmarkFileName);
+
+        return false;
+    }
+
+    if (options.blurBenchmarkFileName != "") {
+        // Needs an OpenGL context, so create a small window that is never shown.  To measure
+        // Mesa's software rasterizer, put its opengl32.dll next to the executable.
+        wxFrame* frame = new wxFrame(NULL, wxID_ANY, "Azrael Blur Benchmark", wxDefaultPosition, wxSize(64, 64));
+
+        int attribList[] = { WX_GL_RGBA,
+                             WX_GL_DOUBLEBUFFER,
+                             0 };
+        wxGLCanvas* canvas = new wxGLCanvas(frame, wxID_ANY, attribList, wxPoint(0, 0), wxSize(64, 64));
+
+        wxGLContext* context = new wxGLContext(canvas);
+        context->SetCurrent(*canvas);
+
+        Benchmark benchmark;
+        benchmark.RunBlur(options.blurBenchmarkFileName);
+
+        delete context;
+        frame->Destroy();
+
+        return false;
+    }
+
+    if (options.convertLogFileName != "") {
+        // Write the text log next to the binary one
+        std::string textFileName = options.convertLogFileName;
+        std::string::size_type extension = textFileName.rfind('.');
+        if (extension != std::string::npos) textFileName.erase(extension);
+        textFileName += ".txt";
+
+        TrackerLogger::ConvertToText(options.convertLogFileName, textFileName);
+
+        return false;
+    }
+
+    if (options.analyzeDirectory != "") {
+        SessionAnalyzer analyzer;
+        analyzer.Run(options.analyzeDirectory);
+
+        return false;
+    }
+
+    if (options.frameCache) {
+        // Write each cache next to its video, where Engine looks for it
+        std::vector<std::string> videoNames;
+        FrameCache::ReadVideoNames("Media/VideoInfo.txt", videoNames);
+
+        for (int i = 0; i < (int)videoNames.size(); i++) {
+            FrameCache::Transcode(videoNames[i], FrameCache::GetFileName(videoNames[i]));
+        }
+
+        return false;
+    }
+
+    if (options.videoBenchmarkFileName != "") {
+        Benchmark benchmark;
+        benchmark.RunVideo(options.videoBenchmarkFileName);
+
+        return false;
+    }
+
+    // Create the main frame window
+    AzraelFrame* frame = new AzraelFrame("Azrael", wxSize(12288, 768), options);
+//AzraelFrame* frame = new AzraelFrame("Azrael", wxSize(3840, (float)(3840 * 768) / (float)12288), options);
+
+    // Show it.  Frames, unlike simple controls, are not shown initially when created.
+    frame->Show();
+
+    // Tell wxWidgets that this is a main frame
+    SetTopWindow(frame);
+
+    // Check initialization
+    if (!frame->Initialize()) {
+        wxLogMessage("Initialization failed.  Exiting...");
+//        return false;
+    }
+
+    // Success:  wxApp::OnRun() will be called which will enter the main message
+    // loop and the application will run. If we returned false here, the
+    // application would exit immediately.
+    return true;
+}
+
+
+bool Azrael::ParseCommandLine(AzraelOptions& options) {
+    static const wxCmdLineEntryDesc commandLineDesc[] = {
+        { wxCMD_LINE_OPTION, "r", "replay", "replay a tracker log instead of using the tracker" },
+        { wxCMD_LINE_OPTION, "s", "speed", "simulation steps per frame when replaying", wxCMD_LINE_VAL_NUMBER },
+        { wxCMD_LINE_OPTION, "e", "seed", "random number seed", wxCMD_LINE_VAL_NUMBER },
+        { wxCMD_LINE_SWITCH, "n", "headless", "update without rendering" },
+        { wxCMD_LINE_SWITCH, "y", "pyramidblur", "blur large radii at reduced resolution, which is faster but blurs in steps" },
+        { wxCMD_LINE_OPTION, "b", "benchmark", "run the benchmarks, writing the results to a file, and exit" },
+        { wxCMD_LINE_OPTION, "g", "blurbenchmark", "run the OpenGL blur benchmarks, writing the results to a file, and exit" },
+        { wxCMD_LINE_OPTION, "c", "convertlog", "convert a binary tracker log to a text log alongside it, and exit" },
+        { wxCMD_LINE_OPTION, "a", "analyze", "write statistics for all tracker logs in a directory, and exit" },
+        { wxCMD_LINE_OPTION, "p", "profile", "time the update and render loop, writing per second percentiles to a file" },
+        { wxCMD_LINE_SWITCH, "f", "framecache", "write a frame cache next to each video in Media/VideoInfo.txt, and exit" },
+        { wxCMD_LINE_OPTION, "v", "videobenchmark", "run the video decoding and frame cache benchmarks, writing the results to a file, and exit" },
+        { wxCMD_LINE_NONE }
+    };
+
+    wxCmdLineParser parser(commandLineDesc, argc, argv);
+    if (parser.Parse() != 0) return false;
+
+    wxString s;
+    if (parser.Found("replay", &s)) {
+        options.replayFileName = s.c_str();
+    }
+
+    long value;
+    if (parser.Found("speed", &value) && value > 0) {
+        options.replaySpeed = (int)value;
+    }
+
+    if (parser.Found("seed", &value)) {
+        options.seed = (unsigned int)value;
+    }
+
+    options.headless = parser.Found("headless");
+
+    options.pyramidBlur = parser.Found("pyramidblur");
+
+    if (parser.Found("benchmark", &s)) {
+        options.benchmarkFileName = s.c_str();
+    }
+
+    if (parser.Found("blurbenchmark", &s)) {
+        options.blurBenchmarkFileName = s.c_str();
+    }
+
+    if (parser.Found("convertlog", &s)) {
+        options.convertLogFileName = s.c_str();
+    }
+
+    if (parser.Found("analyze", &s)) {
+        options.analyzeDirectory = s.c_str();
+    }
+
+    if (parser.Found("profile", &s)) {
+        options.profileFileName = s.c_str();
+    }
+
+    options.frameCache = parser.Found("framecache");
+
+    if (parser.Found("videobenchmark", &s)) {
+        options.videoBenchmarkFileName = s.c_str();
+    }
+
+    return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// AzraelFrame
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+
+BEGIN_EVENT_TABLE(AzraelFrame, wxFrame)
+    EVT_TIMER(TriggerTimerId, AzraelFrame::OnTimer)
+    EVT_TIMER(StateTimerId, AzraelFrame::OnTimer)
+    EVT_TIMER(ViolenceTimerId, AzraelFrame::OnTimer)
+    EVT_IDLE(AzraelFrame::OnIdle)
+END_EVENT_TABLE()
+
+
+const int AzraelFrame::stepInterval = 10;
+const int AzraelFrame::maxStepsPerFrame = 10;
+const int AzraelFrame::triggerInterval = 20 * 1000;
+const int AzraelFrame::frameReportInterval = 10 * 1000;
+
+
+AzraelFrame::AzraelFrame(const wxString& title, const wxSize& size, const AzraelOptions& azraelOptions) 
+: wxFrame((wxFrame*) NULL, wxID_ANY, title, wxPoint(0, 0), size, wxBORDER_NONE | wxSYSTEM_MENU),
+  options(azraelOptions),
+  scheduler(stepInterval, maxStepsPerFrame) {
+    running = false;
+    vsync = false;
+
+    // Create a log window for printing messages
+    log = new wxLogWindow(this, "Log Window", true, false);
+
+    // Not sure how to completely hide the cursor, but this makes it a single black pixel
+    SetCursor(wxImage(1, 1));
+
+    // Set the OpenGL attributes for the canvases
+    int attribList[] = { WX_GL_RGBA,
+                         WX_GL_DOUBLEBUFFER,
+                         0 };
+
+/*
+text = new wxTextCtrl(this, wxID_ANY, "", wxPoint(0, 0), wxSize(size.GetX() / 2, size.GetY() / 2));
+redirect = new wxStreamToTextRedirector(text);
+*/
+
+    // Create two OpenGL canvases
+    int width = size.GetWidth() / 2;
+    int height = size.GetHeight();
+    canvas1 = new AzraelGLCanvas(this, attribList, wxPoint(0, 0), wxSize(width, height));
+    canvas2 = new AzraelGLCanvas(this, attribList, wxPoint(width, 0), wxSize(width, height));
+
+
+    context = new wxGLContext(canvas1);
+    
+
+    // Create a timer for triggering events
+    triggerTimer = new wxTimer(this, TriggerTimerId);
+
+    // Create a timer for triggering changes in state
+    stateTimer = new wxTimer(this, StateTimerId);  
+
+    // Createa a timer for loading a violent image
+    violenceTimer = new wxTimer(this, ViolenceTimerId);
+
+
+    // Seed the random number generator
+    Random::Seed(options.seed);
+
+
+    // Create the engine
+    engine = new Engine();
+}
+
+AzraelFrame::~AzraelFrame() {
+    Profiler::Stop();
+
+    delete engine;
+    delete context;
+}
+
+
+bool AzraelFrame::Initialize() { 
+    context->SetCurrent(*canvas1);
+
+    int width, height;
+    GetClientSize(&width, &height);
+    if (!engine->Initialize((HWND)this->GetHandle(), width, height, options.replayFileName)) {
+        wxLogMessage("Engine::Initialize() : Engine initialization failed.");
+        return false;
+    }
+
+    wxLogMessage("Random seed %u", options.seed);
+
+    if (options.pyramidBlur) {
+        engine->SetBlurMode(BlurShaders::Pyramid);
+    }
+
+    if (options.profileFileName != "") {
+        Profiler::Start(options.profileFileName);
+    }
+
+    // Pace rendering with the display refresh if possible.  Otherwise the main loop would 
+    // just spin.  The interval is set for each canvas in Render().
+    if (WGLEW_EXT_swap_control) {
+        vsync = true;
+    }
+    else {
+        wxLogMessage("AzraelFrame::Initialize() : No vsync control, sleeping between frames instead");
+    }
+
+    int violenceDelay;
+    int stateDelay = GenerateNormalDuration(violenceDelay);
+//stateDelay = 30 * 1000;
+//violenceDelay = 30 * 1000;
+
+    if (options.replayFileName != "") {
+        // Drive the other timers from the simulated clock so the replay is deterministic
+        wxLogMessage("Replaying %s at %dx", options.replayFileName.c_str(), options.replaySpeed);
+
+        simulatedTime = 0;
+        nextTriggerTime = triggerInterval;
+        nextStateTime = stateDelay;
+        nextViolenceTime = violenceDelay;
+
+        replayWatch.Start();
+    }
+    else {
+        triggerTimer->Start(triggerInterval);
+        stateTimer->Start(stateDelay, wxTIMER_ONE_SHOT);
+
+        if (violenceDelay >= 0) {
+            violenceTimer->Start(violenceDelay, wxTIMER_ONE_SHOT);
+        }
+    }
+
+    // Start the main loop
+    scheduler.Start();
+    frameReportWatch.Start();
+    running = true;
+
+    return true;
+}
+
+
+void AzraelFrame::OnIdle(wxIdleEvent& e) {
+    if (!running) return;
+
+    ScopedTimer timer(Profiler::Frame);
+
+    context->SetCurrent(*canvas1);
+
+    int steps = scheduler.BeginFrame();
+
+    if (options.replayFileName != "") {
+        // Replays run a fixed number of steps per frame, independent of the wall clock
+        for (int i = 0; i < options.replaySpeed; i++) {
+            Step();
+        }
+
+        if (engine->ReplayFinished()) {
+            wxLogMessage("Replay finished : %.1f seconds simulated in %.1f seconds", 
+                         simulatedTime * 0.001, replayWatch.Time() * 0.001);
+
+            running = false;
+            Close(true);
+
+            return;
+        }
+
+        engine->SetInterpolation(1.0);
+    }
+    else {
+        for (int i = 0; i < steps; i++) {
+            engine->Update(stepInterval * 0.001);
+        }
+
+        engine->SetInterpolation(scheduler.GetInterpolation());
+    }
+
+    if (!options.headless) Render();
+
+    // Nothing to wait on, so don't spin
+    if (options.headless || !vsync) wxMilliSleep(1);
+
+    ReportFrameTimes();
+    Profiler::EndFrame();
+
+    e.RequestMore();
+}
+
+
+void AzraelFrame::OnTimer(wxTimerEvent& e) {
+    if (e.GetId() == TriggerTimerId) {
+        engine->Trigger();
+    }
+    else if (e.GetId() == StateTimerId) {
+        int violenceDelay;
+        stateTimer->Start(ChangeState(violenceDelay), wxTIMER_ONE_SHOT);
+
+        if (violenceDelay >= 0) {
+            violenceTimer->Start(violenceDelay, wxTIMER_ONE_SHOT);
+        }
+    }
+    else if (e.GetId() == ViolenceTimerId) {
+        engine->DoViolence();
+                
+        // Apparently, the oneShot parameter does nothing, so stop it here
+        violenceTimer->Stop();
+    }
+}
+
+
+void AzraelFrame::Step() {
+    engine->Update(stepInterval * 0.001);
+
+    simulatedTime += stepInterval;
+
+    if (simulatedTime >= nextTriggerTime) {
+        engine->Trigger();
+
+        nextTriggerTime += triggerInterval;
+    }
+
+    if (nextViolenceTime >= 0 && simulatedTime >= nextViolenceTime) {
+        engine->DoViolence();
+
+        nextViolenceTime = -1;
+    }
+
+    if (simulatedTime >= nextStateTime) {
+        int violenceDelay;
+        nextStateTime = simulatedTime + ChangeState(violenceDelay);
+
+        if (violenceDelay >= 0) {
+            nextViolenceTime = simulatedTime + violenceDelay;
+        }
+    }
+}
+
+
+void AzraelFrame::ReportFrameTimes() {
+    if (!Profiler::IsEnabled() || frameReportWatch.Time() < frameReportInterval) return;
+
+    wxLogMessage("Frames : %d, mean %.2f ms, std dev %.2f ms, max %.2f ms, %d steps dropped",
+                 scheduler.GetNumberOfFrames(), scheduler.GetMeanFrameTime(), 
+                 scheduler.GetFrameTimeDeviation(), scheduler.GetMaxFrameTime(), 
+                 scheduler.GetDroppedSteps());
+
+    scheduler.ResetStatistics();
+    frameReportWatch.Start();
+}
+
+
+void AzraelFrame::Render() {
+    context->SetCurrent(*canvas1);
+    engine->RenderLeft();
+
+    context->SetCurrent(*canvas2);
+    engine->RenderRight();
+
+    // Only the first swap waits for the vertical retrace.  The interval goes with the 
+    // canvas the context is current on, and waiting on both would halve the frame rate on
+    // two heads.  Run with --profile to see the time spent in each swap.
+    {
+        ScopedTimer timer(Profiler::SwapBuffersLeft);
+        if (vsync) {
+            context->SetCurrent(*canvas1);
+            wglSwapIntervalEXT(1);
+        }
+        canvas1->SwapBuffers();
+    }
+    {
+        ScopedTimer timer(Profiler::SwapBuffersRight);
+        if (vsync) {
+            context->SetCurrent(*canvas2);
+            wglSwapIntervalEXT(0);
+        }
+        canvas2->SwapBuffers();
+    }
+}
+
+
+int AzraelFrame::ChangeState(int& violenceDelay) {
+    violenceDelay = -1;
+
+    if (engine->GetState() == Engine::Normal) {
+        engine->Victimize();
+
+        return 60 * 1000;
+//return 10 * 1000;
+    }
+    else if (engine->GetState() == Engine::Victimizing) {
+        engine->CoolDown1();
+
+        return 10 * 1000;
+//return 10 * 1000;
+    }
+    else if (engine->GetState() == Engine::CoolingDown1) {
+        engine->CoolDown2();
+
+        return 20 * 1000;
+//return 10 * 1000;
+    }
+    else {
+        engine->Reset();
+
+        return GenerateNormalDuration(violenceDelay);
+//return 30 * 1000;
+    }
+}
+
+int AzraelFrame::GenerateNormalDuration(int& violenceDelay) {
+    int minStart = 8 * 60;
+    int maxStart = 12 * 60;
+    int start = minStart + Random::Int() % (maxStart - minStart);
+
+    // Flip a coin for violence
+    if (Random::Int() % 2 == 0) {
+        violenceDelay = (Random::Int() % start) * 1000;
+    }
+    else {
+        violenceDelay = -1;
+    }
+
+    return start * 1000;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// AzraelGLCanvas
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+
+BEGIN_EVENT_TABLE(AzraelGLCanvas, wxGLCanvas)
+    EVT_PAINT(AzraelGLCanvas::OnPaint)
+    EVT_ERASE_BACKGROUND(AzraelGLCanvas::OnEraseBackground)
+    EVT_CHAR(AzraelGLCanvas::OnKey)
+END_EVENT_TABLE()
+
+
+AzraelGLCanvas::AzraelGLCanvas(wxWindow* parent, int* attribList, const wxPoint& pos, const wxSize& size)
+: wxGLCanvas(parent, wxID_ANY, attribList, pos, size) {
+}
+
+
+void AzraelGLCanvas::OnPaint(wxPaintEvent& WXUNUSED(e)) { 
+    wxPaintDC(this);
+}
+
+void AzraelGLCanvas::OnEraseBackground(wxEraseEvent& WXUNUSED(e)) {
+    // Do nothing, to avoid flashing.
+}
+
+void AzraelGLCanvas::OnKey(wxKeyEvent& e) {
+    int c = e.GetKeyCode();
+    if (c == 'q') {
+        // Quit
+        exit(0);
+    }
 }
\ No newline at end of file
@@ -1,93 +1,171 @@
-///////////////////////////////////////////////////////////////////////////////////////////////
-//
-// Name:        Azrael.h
-//
-// Author:      David Borland
-//
-// Description: wxWidgets code for Azrael, a media installation developed with RENCI Faculty
-//              Fellow Joyce Rudinsky for deployment in the Social Computing Room.
-//
-///////////////////////////////////////////////////////////////////////////////////////////////
-
-
-#ifndef AZRAEL_H
-#define AZRAEL_H
-
-
-#include <wx/wx.h>
-
-#include <GL/glew.h>        // Must be included before glcanvas.h
-#include <wx/glcanvas.h>
-
-#include "Engine.h"
-
-
-// Forward declarations
-class AzraelGLCanvas;
-
-
-// Event Ids
-enum {
-    // Timers
-    RenderTimerId,
-    TriggerTimerId,
-    StateTimerId,
-    ViolenceTimerId
-};
-
-
-// Define a new application type
-class Azrael : public wxApp {
-public:
-    bool OnInit();
-};
-
-
-// Define a new frame type
-class AzraelFrame : public wxFrame {
-public:
-    AzraelFrame(const wxString& title, const wxSize& size);
-    ~AzraelFrame();
-
-    bool Initialize();
-
-    void OnTimer(wxTimerEvent& e);
-
-private:
-    AzraelGLCanvas* canvas1;
-    AzraelGLCanvas* canvas2;
-    wxGLContext* context;
-
-    wxTimer* renderTimer;
-    wxTimer* triggerTimer;
-    wxTimer* stateTimer;
-    wxTimer* violenceTimer;
-
-    wxLogWindow* log;
-
-    wxTextCtrl* text;
-    wxStreamToTextRedirector* redirect;
-
-    Engine* engine;
-
-    void Render();
-    
-    DECLARE_EVENT_TABLE()
-};
-
-
-// Define a new OpenGL canvas type
-class AzraelGLCanvas : public wxGLCanvas {
-public:
-    AzraelGLCanvas(wxWindow *parent, int* attribList, const wxPoint& pos, const wxSize& size);
-
-    void OnPaint(wxPaintEvent& e);
-    void OnEraseBackground(wxEraseEvent& e);
-    void OnKey(wxKeyEvent& e);
-
-private:
-    DECLARE_EVENT_TABLE()
-};
-
-
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        Azrael.h
+//
+// Author:      David Borland
+//
+// Description: wxWidgets code for Azrael, a media installation developed with RENCI Faculty
+//              Fellow Joyce Rudinsky for deployment in the Social Computing Room.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef AZRAEL_H
+#define AZRAEL_H
+
+
+#include <wx/wx.h>
+
+#include <GL/glew.h>        // Must be included before glcanvas.h
+#include <GL/wglew.h>
+#include <wx/glcanvas.h>
+
+#include "Engine.h"
+#include "FrameScheduler.h"
+
+#include <string>
+
+
+// Forward declarations
+class AzraelGLCanvas;
+
+
+// Command line options
+struct AzraelOptions {
+    AzraelOptions();
+
+    // Tracker log to replay instead of using the live tracker
+    std::string replayFileName;
+
+    // Number of simulation steps run per frame when replaying
+    int replaySpeed;
+
+    unsigned int seed;
+
+    // Don't draw anything, just update the engine
+    bool headless;
+
+    // Blur down the pyramid instead of at full resolution
+    bool pyramidBlur;
+
+    // Run the benchmarks, writing the results to this file, and exit
+    std::string benchmarkFileName;
+
+    // Run the blur benchmarks, writing the results to this file, and exit
+    std::string blurBenchmarkFileName;
+
+    // Convert this binary tracker log to text and exit
+    std::string convertLogFileName;
+
+    // Write statistics for the tracker logs in this directory and exit
+    std::string analyzeDirectory;
+
+    // Write a frame cache for each video and exit
+    bool frameCache;
+
+    // Run the video benchmarks, writing the results to this file, and exit
+    std::string videoBenchmarkFileName;
+
+    // Time the update and render loop, writing the summaries to this file
+    std::string profileFileName;
+};
+
+
+// Event Ids
+enum {
+    // Timers
+    TriggerTimerId,
+    StateTimerId,
+    ViolenceTimerId
+};
+
+
+// Define a new application type
+class Azrael : public wxApp {
+public:
+    bool OnInit();
+
+private:
+    bool ParseCommandLine(AzraelOptions& options);
+};
+
+
+// Define a new frame type
+class AzraelFrame : public wxFrame {
+public:
+    AzraelFrame(const wxString& title, const wxSize& size, const AzraelOptions& azraelOptions);
+    ~AzraelFrame();
+
+    bool Initialize();
+
+    void OnIdle(wxIdleEvent& e);
+    void OnTimer(wxTimerEvent& e);
+
+private:
+    AzraelGLCanvas* canvas1;
+    AzraelGLCanvas* canvas2;
+    wxGLContext* context;
+
+    wxTimer* triggerTimer;
+    wxTimer* stateTimer;
+    wxTimer* violenceTimer;
+
+    wxLogWindow* log;
+
+    wxTextCtrl* text;
+    wxStreamToTextRedirector* redirect;
+
+    Engine* engine;
+
+    AzraelOptions options;
+
+    // Simulated clock for replaying, in milliseconds
+    long simulatedTime;
+    long nextTriggerTime;
+    long nextStateTime;
+    long nextViolenceTime;
+
+    wxStopWatch replayWatch;
+
+    // Runs the engine in fixed steps of stepInterval milliseconds, rendering in between
+    FrameScheduler scheduler;
+    bool running;
+    bool vsync;
+
+    wxStopWatch frameReportWatch;
+
+    static const int stepInterval;
+    static const int maxStepsPerFrame;
+    static const int triggerInterval;
+    static const int frameReportInterval;
+
+    void Step();
+    void Render();
+
+    // Logs the frame time statistics every frameReportInterval when profiling
+    void ReportFrameTimes();
+
+    // Advance the engine to the next state.  Returns the time until the next state change, 
+    // and sets violenceDelay to the time until violence, or -1 for no violence.
+    int ChangeState(int& violenceDelay);
+    int GenerateNormalDuration(int& violenceDelay);
+    
+    DECLARE_EVENT_TABLE()
+};
+
+
+// Define a new OpenGL canvas type
+class AzraelGLCanvas : public wxGLCanvas {
+public:
+    AzraelGLCanvas(wxWindow *parent, int* attribList, const wxPoint& pos, const wxSize& size);
+
+    void OnPaint(wxPaintEvent& e);
+    void OnEraseBackground(wxEraseEvent& e);
+    void OnKey(wxKeyEvent& e);
+
+private:
+    DECLARE_EVENT_TABLE()
+};
+
+
 #endif
\ No newline at end of file
@@ -1,487 +1,508 @@
-///////////////////////////////////////////////////////////////////////////////////////////////
-//
-// Name:        AzraelImage.cpp
-//
-// Author:      David Borland
-//
-// Description: Can move around the screen, and perform different effects.
-//
-/////////////////////////////////////////////////////////////////////////////////////////////// 
-
-
-#include <wx/log.h>
-
-
-#include "AzraelImage.h"
-
-
-const unsigned int AzraelImage::maxBlurRadius = 16;
-
-   
-AzraelImage::AzraelImage() : ToroidalImage() {
-    desiredScale = 1.0;
-
-    scaleDirection = 0;
-
-    fade = false;
-    fadeOut = false;
-    opacity = 1.0;
-    float fadeOpacityMin = 0.2f;
-    float fadeOpacityMax = 0.6f;
-    fadeOpacity = (float)rand() / (float)RAND_MAX * (fadeOpacityMax - fadeOpacityMin) + fadeOpacityMin;
-
-    shiftAmount = 0;
-
-    quadrant = -1;
-
-    timer = timerMax = 0;
-
-    blurRadius = maxBlurRadius;
-    actualBlurRadius = maxBlurRadius;
-
-    alignType = None;
-    alignBottom = false;
-
-    dontScale = false;
-}
-
-AzraelImage::~AzraelImage() {
-    glDeleteFramebuffersEXT(1, &fbo);
-    glDeleteTextures(1, &tempBlurTexture);
-    glDeleteTextures(1, &finalBlurTexture);
-}
-
-
-void AzraelImage::SetTexture(GLuint textureMap, unsigned int width, unsigned int height, PixelFormat type) {
-    Image::SetTexture(textureMap, width, height, pixelFormat);
-
-    CreateBlurTextures();
-}
-
-
-void AzraelImage::Update() {
-    // Timer
-    if (timerMax > 0) {
-        timer++;
-    }
-
-    // Update position
-    Vec2 v = desiredPosition - position;
-    position += v * 0.1;
-
-
-    // Update scale
-    float oldScale = scale;
-    const float scaleStep = 0.01f;
-
-    if (scaleDirection == -1) {
-        if (scale > desiredScale) {
-            scale -= scaleStep;
-        }
-        else {
-            scale = desiredScale;
-
-            scaleDirection = 0;
-        }
-    }
-    else if (scaleDirection == 1) {
-        if (scale < desiredScale) {
-            scale += scaleStep;
-        }
-        else {
-            scale = desiredScale;
-
-            scaleDirection = 0;
-        }
-    }
-
-    // Might need to keep aligned if scale changed
-    if (alignType != None) {
-        float offset = aspectRatio * 0.5 * (oldScale - scale);
-        if (alignType == Left) position.X() -= offset;
-        else if (alignType == Right) position.X() += offset;
-
-        desiredPosition.X() = position.X();
-    }
-    if (alignBottom) {
-        position.Y() -= 0.5 * (oldScale - scale);
-
-        desiredPosition.Y() = position.Y();
-    }
-
-
-    // Update actual blur radius
-    if (actualBlurRadius < blurRadius) actualBlurRadius++;
-    else if (actualBlurRadius > blurRadius) actualBlurRadius--;
-
-
-    // Fade
-    if (fade) {
-        float fadeStep = 0.01f;
-        if (opacity > fadeOpacity) opacity -= fadeStep;
-        else opacity = fadeOpacity;
-    }
-    else if (fadeOut) {
-        float fadeStep = 0.01f;
-        if (opacity > 0.0) opacity -= fadeStep;
-    }
-}
-
-
-void AzraelImage::SetDesiredPosition(const Vec2& desiredValue) {
-    desiredPosition = desiredValue;
-}
-
-void AzraelImage::SetDesiredScale(float desiredValue) {
-    if (!dontScale) {
-        desiredScale = desiredValue;
-
-        if (scale < desiredScale) scaleDirection = 1;
-        else if (scale > desiredScale) scaleDirection = -1;
-        else scaleDirection = 0;
-    }
-    else {
-        scale = desiredScale = 1.0;
-    }
-}
-
-
-void AzraelImage::SetDontScale(bool flag) {
-    dontScale = flag;
-}
-
-
-void AzraelImage::GeneratePosition() {
-    if (quadrant < 0) {
-        // Put anywhere in X
-        position.X() = (float)rand() / (float)RAND_MAX * (xMax - xMin);
-
-        // Constrain so all is showing in Y
-        float yPlay = 1.0 - scale;
-        float yOffset = ((float)rand() / (float)RAND_MAX - 0.5) * yPlay;
-        position.Y() = 0.5 + yOffset;
-    }
-    else {
-        // Put in the given quadrant
-        float quadrantWidth = (xMax - xMin) * 0.25;
-
-        // X
-        if (alignType == Left) {
-            position.X() = quadrant * quadrantWidth + aspectRatio * 0.5 * scale;
-        }
-        else if (alignType == Right) {
-            float q = quadrant == 0 ? 4 : quadrant;
-            position.X() = q * quadrantWidth - aspectRatio * 0.5 * scale;
-        }
-        else {     
-            // Generate a random number in the range 0...1
-            float value = (float)rand() / (float)RAND_MAX;
-
-            // Offset to the correct quadrant
-            if (quadrant == 0) {
-                // Quadrant 0 wraps around the screen
-                if (value < 0.5) {
-                    position.X() = value * quadrantWidth;
-                }
-                else {
-                    position.X() = 3.5 * quadrantWidth + (1.0 - value) * quadrantWidth;
-                }
-            }
-            else {
-                position.X() = (quadrant - 0.5) * quadrantWidth + value * quadrantWidth;
-            }
-        }
-
-
-        // Y
-        if (alignBottom) {
-            position.Y() = 0.5 * scale;
-        }
-        else {
-            float yPlay = 1.0 - scale;
-            float yOffset = ((float)rand() / (float)RAND_MAX - 0.5) * yPlay;
-            position.Y() = 0.5 + yOffset;
-        }
-    }
-
-    desiredPosition = position;
-}
-
-
-void AzraelImage::Fade() {
-    fade = true;
-    fadeOut = false;
-}
-
-void AzraelImage::FadeOut() {
-    fadeOut = true;
-    fade = false;
-}
-
-
-bool AzraelImage::FadedOut() {
-    if (opacity <= 0.0) {
-        return true;
-    }
-    else {
-        return false;
-    }
-}
-
-bool AzraelImage::Rendered() {
-    return true;
-}
-
-void AzraelImage::SetRendered() {
-}
-
-void AzraelImage::Shift() {
-    shiftAmount = rand() % 16 + 5;
-}
-
-void AzraelImage::NoShift() {
-    shiftAmount = 0;
-}
-
-
-void AzraelImage::SetAlignType(AlignType align) {
-    alignType = align;
-}
-
-AzraelImage::AlignType AzraelImage::GetAlignType() const {
-    return alignType;
-}
-
-
-void AzraelImage::SetAlignBottom(bool align) {
-    alignBottom = align;
-}
-
-bool AzraelImage::AlignBottom() const {
-    return alignBottom;
-}
-
-
-void AzraelImage::SetQuadrant(int whichQuadrant) {
-    quadrant = whichQuadrant;
-}
-
-int AzraelImage::GetQuadrant() const {
-    return quadrant;
-}
-
-
-
-bool AzraelImage::DeleteOnNewQuadrant() {
-    return false;
-}
-
-
-void AzraelImage::SetTimer() {
-    int min = 25;
-    int max = 50;
-    timerMax = rand() % (max - min) + min;
-}
-
-bool AzraelImage::TimedOut() {
-    return timer > timerMax;
-}
-
-
-void AzraelImage::SetFadeFragmentProgram(GLhandleARB fragmentProgram, GLint parameter1, GLint parameter2) {
-    fadeFragmentProgram = fragmentProgram;
-    opacityParameter = parameter1;
-    shiftParameter = parameter2;
-}
-
-
-void AzraelImage::SetBlurFragmentPrograms(GLhandleARB horizontalFragmentProgram, GLint horizontalParameter,
-                                          GLhandleARB verticalFragmentProgram, GLint verticalParameter) {
-    horizontalBlurFragmentProgram = horizontalFragmentProgram;
-    horizontalBlurParameter = horizontalParameter;
-    verticalBlurFragmentProgram = verticalFragmentProgram;
-    verticalBlurParameter = verticalParameter;
-}
-
-
-void AzraelImage::PreRender() {
-    // Enable blending
-    glEnable(GL_BLEND);
-    glColor4f(1.0, 1.0, 1.0, 1.0);
-
-
-    // Enable texturing
-//    glEnable(GL_TEXTURE_RECTANGLE_ARB);
-
-    // Bind the texture
-    GLint useTexture = texture;
-    if (actualBlurRadius > 0) {
-        DoBlur();
-        useTexture = finalBlurTexture;
-    }
-    glBindTexture(GL_TEXTURE_RECTANGLE_ARB, useTexture);
-
-
-    // Fade fragment program
-    glUseProgramObjectARB(fadeFragmentProgram);
-    glUniform1fARB(opacityParameter, (GLfloat)opacity);
-    glUniform1iARB(shiftParameter, (GLint)shiftAmount);
-}
-
-
-void AzraelImage::PostRender() {
-    // Fragment program
-    glUseProgramObjectARB(0);
-
-    // Disable texturing
-    glDisable(GL_TEXTURE_RECTANGLE_ARB);
-
-    // Disable blending
-    glDisable(GL_BLEND);
-}
-
-
-void AzraelImage::DoBlur() {
-    // Setup for both blur passes
-    glPushAttrib(GL_VIEWPORT_BIT | GL_COLOR_BUFFER_BIT);
-
-    glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, fbo);
-
-    glViewport(0, 0, resolution[0], resolution[1]);
-
-    glMatrixMode(GL_PROJECTION);
-    glPushMatrix();
-    glLoadIdentity();
-    glOrtho(0.0, 1.0, 0.0, 1.0, -1.0, 1.0);
-
-    glDrawBuffer(GL_COLOR_ATTACHMENT0_EXT);
-
-
-    // Horizontal blur
-    glDrawBuffer(GL_COLOR_ATTACHMENT0_EXT);
-    glClear(GL_COLOR_BUFFER_BIT);
-
-    glBindTexture(GL_TEXTURE_RECTANGLE_ARB, texture);
-
-    glUseProgramObjectARB(horizontalBlurFragmentProgram);
-    glUniform1iARB(horizontalBlurParameter, actualBlurRadius);
-    
-    glBegin(GL_QUADS);
-        glTexCoord2d(0, 0);
-        glVertex2f(0.0, 0.0);
-
-        glTexCoord2d(resolution[0], 0);
-        glVertex2f(1.0, 0.0);
-
-        glTexCoord2d(resolution[0], resolution[1]);
-        glVertex2f(1.0, 1.0);
-
-        glTexCoord2d(0, resolution[1]);
-        glVertex2f(0.0, 1.0);
-    glEnd();
-
-
-    // Vertical blur
-    glDrawBuffer(GL_COLOR_ATTACHMENT1_EXT);
-    glClear(GL_COLOR_BUFFER_BIT);
-
-    glBindTexture(GL_TEXTURE_RECTANGLE_ARB, tempBlurTexture);
-
-    glUseProgramObjectARB(verticalBlurFragmentProgram);
-    glUniform1iARB(verticalBlurParameter, actualBlurRadius);
-    
-    glBegin(GL_QUADS);
-        glTexCoord2d(0, 0);
-        glVertex2f(0.0, 0.0);
-
-        glTexCoord2d(resolution[0], 0);
-        glVertex2f(1.0, 0.0);
-
-        glTexCoord2d(resolution[0], resolution[1]);
-        glVertex2f(1.0, 1.0);
-
-        glTexCoord2d(0, resolution[1]);
-        glVertex2f(0.0, 1.0);
-    glEnd();
-
-
-    // Restore state
-    glPopMatrix();
-
-    glPopAttrib();
-    glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, 0);
-
-    glUseProgramObjectARB(0);
-}
-
-
-void AzraelImage::CreateTexture() {
-    Image::CreateTexture();
-
-    CreateBlurTextures();
-}
-
-
-void AzraelImage::CreateBlurTextures() {
-    // Create the fbo
-    glGenFramebuffersEXT(1, &fbo);
-    glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, fbo);
-
-    
-    // Create the first texture
-    glGenTextures(1, &tempBlurTexture);
-    glBindTexture(GL_TEXTURE_RECTANGLE_ARB, tempBlurTexture);
-    glTexParameteri(GL_TEXTURE_RECTANGLE_ARB, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_RECTANGLE_ARB, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_RECTANGLE_ARB, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_RECTANGLE_ARB, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
-
-    if (pixelFormat == LUMINANCE) {
-        glTexImage2D(GL_TEXTURE_RECTANGLE_ARB, 0, GL_LUMINANCE, resolution[0], resolution[1], 0, GL_LUMINANCE, GL_UNSIGNED_BYTE, NULL);
-    }
-    else if (pixelFormat == RGB || pixelFormat == BGR) {
-        glTexImage2D(GL_TEXTURE_RECTANGLE_ARB, 0, GL_RGB, resolution[0], resolution[1], 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
-    }
-    else if (pixelFormat == RGBA || pixelFormat == BGRA) {
-        glTexImage2D(GL_TEXTURE_RECTANGLE_ARB, 0, GL_RGBA, resolution[0], resolution[1], 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
-    }
-
-    // Attach the texture to the fbo
-    glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, GL_TEXTURE_RECTANGLE_ARB, tempBlurTexture, 0);
-
-
-    // Create the second texture
-    glGenTextures(1, &finalBlurTexture);
-    glBindTexture(GL_TEXTURE_RECTANGLE_ARB, finalBlurTexture);
-    glTexParameteri(GL_TEXTURE_RECTANGLE_ARB, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_RECTANGLE_ARB, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_RECTANGLE_ARB, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_RECTANGLE_ARB, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
-
-    if (pixelFormat == LUMINANCE) {
-        glTexImage2D(GL_TEXTURE_RECTANGLE_ARB, 0, GL_LUMINANCE, resolution[0], resolution[1], 0, GL_LUMINANCE, GL_UNSIGNED_BYTE, NULL);
-    }
-    else if (pixelFormat == RGB || pixelFormat == BGR) {
-        glTexImage2D(GL_TEXTURE_RECTANGLE_ARB, 0, GL_RGB, resolution[0], resolution[1], 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
-    }
-    else if (pixelFormat == RGBA || pixelFormat == BGRA) {
-        glTexImage2D(GL_TEXTURE_RECTANGLE_ARB, 0, GL_RGBA, resolution[0], resolution[1], 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
-    }
-
-    // Attach the texture to the fbo
-    glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT1_EXT, GL_TEXTURE_RECTANGLE_ARB, finalBlurTexture, 0);
-
-
-    // Unbind the fbo
-    glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, 0);
-}
-
-void AzraelImage::CleanUp() {
-    Image::CleanUp();
-
-    glDeleteBuffersARB(1, &fbo);
-    glDeleteTextures(1, &tempBlurTexture);
-    glDeleteTextures(1, &finalBlurTexture);
-}
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        AzraelImage.cpp
+//
+// Author:      David Borland
+//
+// Description: Can move around the screen, and perform different effects.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////// 
+
+
+#include <wx/log.h>
+
+
+#include "AzraelImage.h"
+#include "Random.h"
+#include "Profiler.h"
+#include "Animation.h"
+
+#include <math.h>
+
+
+const unsigned int AzraelImage::maxBlurRadius = 16;
+
+// These match the original per-update steps at 100 updates per second:  10% of the way to
+// the desired position, 0.01 scale, 0.01 opacity, and one pixel of blur per update
+const float AzraelImage::positionRate = Animation::ExponentialRate(0.1f, 0.01);
+const float AzraelImage::scaleSpeed = 1.0f;
+const float AzraelImage::fadeSpeed = 1.0f;
+const double AzraelImage::blurStepTime = 10.0;
+
+   
+AzraelImage::AzraelImage() : ToroidalImage() {
+    hasTexture = false;
+    textureOrigin[0] = 0;
+    textureOrigin[1] = 0;
+
+    pixelBuffers = NULL;
+
+    blurShaders = NULL;
+    blurTargets = NULL;
+    blurTarget = NULL;
+    blurredRadius = 0;
+    blurDirty = true;
+
+    AzraelImage::Reset();
+}
+
+AzraelImage::~AzraelImage() {
+    ReleaseBlurTarget();
+
+    delete pixelBuffers;
+}
+
+
+void AzraelImage::Reset() {
+    desiredScale = 1.0;
+
+    scaleDirection = 0;
+
+    hasPreviousState = false;
+
+    fade = false;
+    fadeOut = false;
+    opacity = 1.0;
+    float fadeOpacityMin = 0.2f;
+    float fadeOpacityMax = 0.6f;
+    fadeOpacity = Random::Float() * (fadeOpacityMax - fadeOpacityMin) + fadeOpacityMin;
+
+    shiftAmount = 0;
+
+    quadrant = -1;
+
+    timer = 0.0;
+    timerMax = 0;
+
+    blurRadius = maxBlurRadius;
+    actualBlurRadius = maxBlurRadius;
+    blurTime = 0.0;
+
+    ReleaseBlurTarget();
+
+    alignType = None;
+    alignBottom = false;
+
+    dontScale = false;
+}
+
+
+unsigned int AzraelImage::GetMaxBlurRadius() {
+    return maxBlurRadius;
+}
+
+
+bool AzraelImage::HasTexture() const {
+    return hasTexture;
+}
+
+unsigned int AzraelImage::GetTextureWidth() const {
+    return resolution[0];
+}
+
+unsigned int AzraelImage::GetTextureHeight() const {
+    return resolution[1];
+}
+
+Image::PixelFormat AzraelImage::GetPixelFormat() const {
+    return pixelFormat;
+}
+
+
+void AzraelImage::SetTexture(GLuint textureMap, unsigned int width, unsigned int height, PixelFormat type) {
+    Image::SetTexture(textureMap, width, height, type);
+
+    hasTexture = true;
+    textureOrigin[0] = 0;
+    textureOrigin[1] = 0;
+    blurDirty = true;
+}
+
+void AzraelImage::SetTextureOrigin(unsigned int x, unsigned int y) {
+    textureOrigin[0] = x;
+    textureOrigin[1] = y;
+    blurDirty = true;
+}
+
+void AzraelImage::SetTextureData(void* data) {
+    // The first frame creates the texture
+    if (!hasTexture) {
+        Image::SetTextureData(data);
+    }
+    else {
+        if (!pixelBuffers) pixelBuffers = new PixelBufferStream();
+
+        if (!pixelBuffers->Initialize(resolution[0], resolution[1], pixelFormat) ||
+            !pixelBuffers->Upload(texture, data)) {
+            Image::SetTextureData(data);
+        }
+    }
+
+    // VideoFile doesn't say whether a new frame was decoded, so treat each call as one
+    blurDirty = true;
+}
+
+
+void AzraelImage::Update(double seconds) {
+    // Keep the previous state for interpolation
+    previousPosition = position;
+    previousScale = scale;
+    previousOpacity = opacity;
+    hasPreviousState = true;
+
+    double milliseconds = seconds * 1000.0;
+
+    // Timer
+    if (timerMax > 0) {
+        timer += milliseconds;
+    }
+
+    // Update position
+    position = Animation::Exponential(position, desiredPosition, positionRate, seconds);
+
+
+    // Update scale
+    float oldScale = scale;
+
+    if (scaleDirection != 0) {
+        scale = Animation::Linear(scale, desiredScale, scaleSpeed, seconds);
+
+        if (scale == desiredScale) scaleDirection = 0;
+    }
+
+    // Might need to keep aligned if scale changed
+    if (alignType != None) {
+        float offset = aspectRatio * 0.5 * (oldScale - scale);
+        if (alignType == Left) position.X() -= offset;
+        else if (alignType == Right) position.X() += offset;
+
+        desiredPosition.X() = position.X();
+    }
+    if (alignBottom) {
+        position.Y() -= 0.5 * (oldScale - scale);
+
+        desiredPosition.Y() = position.Y();
+    }
+
+
+    // Update actual blur radius, one pixel per blurStepTime
+    if (actualBlurRadius == blurRadius) {
+        blurTime = 0.0;
+    }
+    else {
+        blurTime += milliseconds;
+
+        while (blurTime >= blurStepTime && actualBlurRadius != blurRadius) {
+            if (actualBlurRadius < blurRadius) actualBlurRadius++;
+            else actualBlurRadius--;
+
+            blurTime -= blurStepTime;
+        }
+    }
+
+
+    // Fade
+    if (fade) {
+        if (opacity > fadeOpacity) opacity = Animation::Linear(opacity, fadeOpacity, fadeSpeed, seconds);
+        else opacity = fadeOpacity;
+    }
+    else if (fadeOut) {
+        opacity = Animation::Linear(opacity, 0.0, fadeSpeed, seconds);
+    }
+}
+
+
+void AzraelImage::BeginInterpolation(float alpha) {
+    savedPosition = position;
+    savedScale = scale;
+    savedOpacity = opacity;
+
+    if (!hasPreviousState) return;
+
+    // Don't interpolate across a jump, e.g. wrapping around the screen or being placed
+    Vec2 v = position - previousPosition;
+    if (fabs(v.X()) < (xMax - xMin) * 0.25 && fabs(v.Y()) < 0.5) {
+        position = previousPosition + v * alpha;
+    }
+
+    scale = previousScale + (savedScale - previousScale) * alpha;
+    opacity = previousOpacity + (savedOpacity - previousOpacity) * alpha;
+}
+
+void AzraelImage::EndInterpolation() {
+    position = savedPosition;
+    scale = savedScale;
+    opacity = savedOpacity;
+}
+
+
+bool AzraelImage::IsVisible(float left, float right) const {
+    float halfWidth = aspectRatio * 0.5f * (float)scale;
+    float viewWidth = xMax - xMin;
+
+    // Check the copies a view width either side as well
+    for (int i = -1; i <= 1; i++) {
+        float x = (float)position.X() + i * viewWidth;
+        if (x + halfWidth > left && x - halfWidth < right) return true;
+    }
+
+    return false;
+}
+
+
+void AzraelImage::AddToBatch(SpriteBatch& batch, float left, float right) {
+    if (!hasTexture) return;
+
+    SpriteState state;
+    state.program = fadeFragmentProgram;
+    state.target = GL_TEXTURE_RECTANGLE_ARB;
+    state.texture = PrepareTexture();
+    state.blend = true;
+
+    // The blurred copy has a texture of its own
+    float s = 0.0f;
+    float t = 0.0f;
+    if (!blurTarget) {
+        s = (float)textureOrigin[0];
+        t = (float)textureOrigin[1];
+    }
+
+    float halfWidth = aspectRatio * 0.5f * (float)scale;
+    float halfHeight = 0.5f * (float)scale;
+    float y = (float)position.Y();
+    float viewWidth = xMax - xMin;
+
+    // Draw the copies a view width either side where the image wraps around
+    for (int i = -1; i <= 1; i++) {
+        float x = (float)position.X() + i * viewWidth;
+        if (x + halfWidth <= left || x - halfWidth >= right) continue;
+
+        batch.Add(state, x - halfWidth, y - halfHeight, x + halfWidth, y + halfHeight,
+                  s, t, s + resolution[0], t + resolution[1], 
+                  opacity, (float)shiftAmount);
+    }
+}
+
+
+void AzraelImage::SetDesiredPosition(const Vec2& desiredValue) {
+    desiredPosition = desiredValue;
+}
+
+void AzraelImage::SetDesiredScale(float desiredValue) {
+    if (!dontScale) {
+        desiredScale = desiredValue;
+
+        if (scale < desiredScale) scaleDirection = 1;
+        else if (scale > desiredScale) scaleDirection = -1;
+        else scaleDirection = 0;
+    }
+    else {
+        scale = desiredScale = 1.0;
+    }
+}
+
+
+void AzraelImage::SetDontScale(bool flag) {
+    dontScale = flag;
+}
+
+
+void AzraelImage::GeneratePosition() {
+    if (quadrant < 0) {
+        // Put anywhere in X
+        position.X() = Random::Float() * (xMax - xMin);
+
+        // Constrain so all is showing in Y
+        float yPlay = 1.0 - scale;
+        float yOffset = (Random::Float() - 0.5) * yPlay;
+        position.Y() = 0.5 + yOffset;
+    }
+    else {
+        // Put in the given quadrant
+        float quadrantWidth = (xMax - xMin) * 0.25;
+
+        // X
+        if (alignType == Left) {
+            position.X() = quadrant * quadrantWidth + aspectRatio * 0.5 * scale;
+        }
+        else if (alignType == Right) {
+            float q = quadrant == 0 ? 4 : quadrant;
+            position.X() = q * quadrantWidth - aspectRatio * 0.5 * scale;
+        }
+        else {     
+            // Generate a random number in the range 0...1
+            float value = Random::Float();
+
+            // Offset to the correct quadrant
+            if (quadrant == 0) {
+                // Quadrant 0 wraps around the screen
+                if (value < 0.5) {
+                    position.X() = value * quadrantWidth;
+                }
+                else {
+                    position.X() = 3.5 * quadrantWidth + (1.0 - value) * quadrantWidth;
+                }
+            }
+            else {
+                position.X() = (quadrant - 0.5) * quadrantWidth + value * quadrantWidth;
+            }
+        }
+
+
+        // Y
+        if (alignBottom) {
+            position.Y() = 0.5 * scale;
+        }
+        else {
+            float yPlay = 1.0 - scale;
+            float yOffset = (Random::Float() - 0.5) * yPlay;
+            position.Y() = 0.5 + yOffset;
+        }
+    }
+
+    desiredPosition = position;
+}
+
+
+void AzraelImage::Fade() {
+    fade = true;
+    fadeOut = false;
+}
+
+void AzraelImage::FadeOut() {
+    fadeOut = true;
+    fade = false;
+}
+
+
+bool AzraelImage::FadedOut() {
+    if (opacity <= 0.0) {
+        return true;
+    }
+    else {
+        return false;
+    }
+}
+
+bool AzraelImage::Rendered() {
+    return true;
+}
+
+void AzraelImage::SetRendered() {
+}
+
+void AzraelImage::Shift() {
+    shiftAmount = Random::Int() % 16 + 5;
+}
+
+void AzraelImage::NoShift() {
+    shiftAmount = 0;
+}
+
+
+void AzraelImage::SetAlignType(AlignType align) {
+    alignType = align;
+}
+
+AzraelImage::AlignType AzraelImage::GetAlignType() const {
+    return alignType;
+}
+
+
+void AzraelImage::SetAlignBottom(bool align) {
+    alignBottom = align;
+}
+
+bool AzraelImage::AlignBottom() const {
+    return alignBottom;
+}
+
+
+void AzraelImage::SetQuadrant(int whichQuadrant) {
+    quadrant = whichQuadrant;
+}
+
+int AzraelImage::GetQuadrant() const {
+    return quadrant;
+}
+
+
+
+bool AzraelImage::DeleteOnNewQuadrant() {
+    return false;
+}
+
+
+void AzraelImage::SetTimer() {
+    // Hundredths of a second
+    int min = 25;
+    int max = 50;
+    timerMax = (Random::Int() % (max - min) + min) * 10;
+}
+
+bool AzraelImage::TimedOut() {
+    return timer > timerMax;
+}
+
+
+void AzraelImage::SetFadeFragmentProgram(GLhandleARB fragmentProgram) {
+    fadeFragmentProgram = fragmentProgram;
+}
+
+
+void AzraelImage::SetBlurShaders(const BlurShaders* shaders) {
+    blurShaders = shaders;
+}
+
+void AzraelImage::SetBlurTargetCache(BlurTargetCache* cache) {
+    blurTargets = cache;
+}
+
+
+GLuint AzraelImage::PrepareTexture() {
+    // Only blur again if something changed since the last time.  Both canvases draw the 
+    // same blurred copy.
+    if (actualBlurRadius > 0 && blurTargets && blurShaders) {
+        if (!blurTarget) {
+            blurTarget = blurTargets->Acquire(resolution[0], resolution[1], pixelFormat);
+            blurDirty = true;
+        }
+
+        if (blurDirty || blurredRadius != actualBlurRadius) {
+            DoBlur();
+
+            blurredRadius = actualBlurRadius;
+            blurDirty = false;
+        }
+
+        return blurTarget->finalTexture;
+    }
+
+    ReleaseBlurTarget();
+
+    return texture;
+}
+
+
+void AzraelImage::DoBlur() {
+    ScopedTimer timer(Profiler::DoBlur);
+
+    blurShaders->Blur(texture, blurTarget, resolution[0], resolution[1], actualBlurRadius,
+                      textureOrigin[0], textureOrigin[1]);
+}
+
+
+void AzraelImage::ReleaseBlurTarget() {
+    if (!blurTarget) return;
+
+    blurTargets->Release(blurTarget);
+    blurTarget = NULL;
+}
+
+
+void AzraelImage::CreateTexture() {
+    Image::CreateTexture();
+
+    hasTexture = true;
+    blurDirty = true;
+}
\ No newline at end of file
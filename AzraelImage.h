@@ -1,125 +1,200 @@
-///////////////////////////////////////////////////////////////////////////////////////////////
-//
-// Name:        AzraelImage.h
-//
-// Author:      David Borland
-//
-// Description: Abstract class for moving around the screen and perform different effects
-//
-/////////////////////////////////////////////////////////////////////////////////////////////// 
-
-
-#ifndef AZRAELIMAGE_H
-#define AZRAELIMAGE_H
-
-
-#include <ToroidalImage.h>
-
-#include <VideoFile.h>
-
-
-class AzraelImage : public ToroidalImage {
-public:    
-    AzraelImage();
-    virtual ~AzraelImage();
-
-    virtual void SetTexture(GLuint textureMap, unsigned int width, unsigned int height, PixelFormat type);
-
-    virtual void Update();
-    virtual void UpdateDistance(float distance) = 0;
-
-    void SetDesiredPosition(const Vec2& desiredValue);
-    void SetDesiredScale(float desiredValue);
-
-    void SetDontScale(bool flag);
-
-    virtual void GeneratePosition();
-
-    void Fade();
-    void FadeOut();
-    bool FadedOut();
-
-    virtual bool Rendered();
-    virtual void SetRendered();
-
-    virtual void Shift();
-    virtual void NoShift();
-
-    enum AlignType {
-        None,
-        Left,
-        Right
-    };
-
-    void SetAlignType(AlignType align);
-    AlignType GetAlignType() const;
-
-    void SetAlignBottom(bool align);
-    bool AlignBottom() const;
-
-    void SetQuadrant(int whichQuadrant);
-    int GetQuadrant() const;
-
-    virtual bool DeleteOnNewQuadrant();
-
-    void SetTimer();
-    bool TimedOut();
-
-    void SetFadeFragmentProgram(GLhandleARB fragmentProgram, GLint parameter1, GLint parameter2);
-    void SetBlurFragmentPrograms(GLhandleARB horizontalFragmentProgram, GLint horizontalParameter,
-                                 GLhandleARB verticalFragmentProgram, GLint verticalParameter); 
-
-protected:
-    // Decoupling from actual values for smoother animation
-    Vec2 desiredPosition;
-    float desiredScale;
-
-    int scaleDirection;
-
-    bool fade;
-    bool fadeOut;
-    float opacity;
-    float fadeOpacity;
-
-    int shiftAmount;
-
-    AlignType alignType;
-    bool alignBottom;
-
-    bool dontScale;
-
-    int quadrant;
-
-    int timer;
-    int timerMax;
-
-    unsigned int blurRadius;
-    unsigned int actualBlurRadius;
-
-    const static unsigned int maxBlurRadius;
-
-    GLhandleARB fadeFragmentProgram;
-    GLint opacityParameter;
-    GLint shiftParameter;
-
-    GLhandleARB horizontalBlurFragmentProgram;
-    GLint horizontalBlurParameter;
-
-    GLhandleARB verticalBlurFragmentProgram;
-    GLint verticalBlurParameter;
-
-    GLuint fbo;
-    GLuint tempBlurTexture;
-    GLuint finalBlurTexture;
-
-    virtual void PreRender();
-    virtual void PostRender();
-    void DoBlur(); 
-
-    virtual void CreateTexture();
-    void CreateBlurTextures();    
-    virtual void CleanUp();
-};
-
-
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        AzraelImage.h
+//
+// Author:      David Borland
+//
+// Description: Abstract class for moving around the screen and perform different effects
+//
+/////////////////////////////////////////////////////////////////////////////////////////////// 
+
+
+#ifndef AZRAELIMAGE_H
+#define AZRAELIMAGE_H
+
+
+#include <ToroidalImage.h>
+
+#include <VideoFile.h>
+
+#include "BlurTargetCache.h"
+#include "BlurShaders.h"
+#include "SpriteBatch.h"
+#include "PixelBufferStream.h"
+
+
+class AzraelImage : public ToroidalImage {
+public:    
+    AzraelImage();
+    virtual ~AzraelImage();
+
+    virtual void SetTexture(GLuint textureMap, unsigned int width, unsigned int height, PixelFormat type);
+
+    // Where the image starts in its texture, for images packed into a TextureAtlas.  Call
+    // after SetTexture(), which sets it back to the corner.
+    void SetTextureOrigin(unsigned int x, unsigned int y);
+
+    // Also marks the blurred copy out of date, so call this through an AzraelImage.  Once 
+    // the texture exists, data is streamed through pixel buffers.
+    void SetTextureData(void* data);
+
+    enum Type {
+        Quadrant,
+        Fragment,
+        Guard,
+        Patch,
+        Avatar,
+        Violent
+    };
+
+    virtual Type GetType() const = 0;
+
+    // Largest blur radius any image uses
+    static unsigned int GetMaxBlurRadius();
+
+    // Puts the image back the way it was constructed, keeping the texture but giving back 
+    // any blur target, so it can be reused by the ImagePool
+    virtual void Reset();
+
+    bool HasTexture() const;
+    unsigned int GetTextureWidth() const;
+    unsigned int GetTextureHeight() const;
+    PixelFormat GetPixelFormat() const;
+
+    virtual void Update(double seconds);
+    virtual void UpdateDistance(float distance) = 0;
+
+    // Moves the image part of the way from its state before the last Update() to its 
+    // current state, for rendering between updates.  EndInterpolation() puts it back.
+    void BeginInterpolation(float alpha);
+    void EndInterpolation();
+
+    // Whether any of the image, including where it wraps around the view, falls between 
+    // left and right
+    bool IsVisible(float left, float right) const;
+
+    // Adds a quad for each copy of the image between left and right, blurring first if needed
+    void AddToBatch(SpriteBatch& batch, float left, float right);
+
+    void SetDesiredPosition(const Vec2& desiredValue);
+    void SetDesiredScale(float desiredValue);
+
+    void SetDontScale(bool flag);
+
+    virtual void GeneratePosition();
+
+    void Fade();
+    void FadeOut();
+    bool FadedOut();
+
+    virtual bool Rendered();
+    virtual void SetRendered();
+
+    virtual void Shift();
+    virtual void NoShift();
+
+    enum AlignType {
+        None,
+        Left,
+        Right
+    };
+
+    void SetAlignType(AlignType align);
+    AlignType GetAlignType() const;
+
+    void SetAlignBottom(bool align);
+    bool AlignBottom() const;
+
+    void SetQuadrant(int whichQuadrant);
+    int GetQuadrant() const;
+
+    virtual bool DeleteOnNewQuadrant();
+
+    void SetTimer();
+    bool TimedOut();
+
+    // Opacity and shift are passed to the program per vertex
+    void SetFadeFragmentProgram(GLhandleARB fragmentProgram);
+    void SetBlurShaders(const BlurShaders* shaders);
+
+    // Where to borrow render targets from when blurring
+    void SetBlurTargetCache(BlurTargetCache* cache);
+
+protected:
+    // Decoupling from actual values for smoother animation
+    Vec2 desiredPosition;
+    float desiredScale;
+
+    int scaleDirection;
+
+    // State before the last Update(), and the actual state while interpolating
+    bool hasPreviousState;
+    Vec2 previousPosition;
+    float previousScale;
+    float previousOpacity;
+
+    Vec2 savedPosition;
+    float savedScale;
+    float savedOpacity;
+
+    bool fade;
+    bool fadeOut;
+    float opacity;
+    float fadeOpacity;
+
+    int shiftAmount;
+
+    AlignType alignType;
+    bool alignBottom;
+
+    bool dontScale;
+
+    int quadrant;
+
+    // Milliseconds
+    double timer;
+    int timerMax;
+
+    unsigned int blurRadius;
+    unsigned int actualBlurRadius;
+
+    // Milliseconds since the actual blur radius last moved toward blurRadius
+    double blurTime;
+
+    const static unsigned int maxBlurRadius;
+
+    // Animation speeds, per second
+    const static float positionRate;
+    const static float scaleSpeed;
+    const static float fadeSpeed;
+
+    // Milliseconds per pixel of blur radius change
+    const static double blurStepTime;
+
+    GLhandleARB fadeFragmentProgram;
+
+    const BlurShaders* blurShaders;
+
+    bool hasTexture;
+    unsigned int textureOrigin[2];
+
+    // Created on the second call to SetTextureData(), so only images that change get one
+    PixelBufferStream* pixelBuffers;
+
+    // Held while the image is blurred, so the blurred copy can be drawn again until the 
+    // texture or radius changes
+    BlurTargetCache* blurTargets;
+    BlurTarget* blurTarget;
+    unsigned int blurredRadius;
+    bool blurDirty;
+
+    // The texture to draw from, blurring into the blur target if needed
+    GLuint PrepareTexture();
+    void DoBlur(); 
+    void ReleaseBlurTarget();
+
+    virtual void CreateTexture();
+};
+
+
 #endif
\ No newline at end of file
@@ -1,47 +1,289 @@
-///////////////////////////////////////////////////////////////////////////////////////////////
-//
-// Name:        AzraelVideo.cpp
-//
-// Author:      David Borland
-//
-// Description: Adds some information about alignment.
-//
-/////////////////////////////////////////////////////////////////////////////////////////////// 
-
-
-#include "AzraelVideo.h"
-
-
-AzraelVideo::AzraelVideo() : VideoFile() {
-    alignType = AzraelImage::None;
-    alignBottom = false;
-
-    dontScale = false;
-}
-
-
-void AzraelVideo::SetAlignType(AzraelImage::AlignType align) {
-    alignType = align;
-}
-
-void AzraelVideo::SetAlignBottom(bool align) {
-    alignBottom = align;
-}
-
-
-AzraelImage::AlignType AzraelVideo::GetAlignType() const {
-    return alignType;
-}
-
-bool AzraelVideo::GetAlignBottom() const {
-    return alignBottom;
-}
-
-
-void AzraelVideo::SetDontScale(bool flag) {
-    dontScale = flag;
-}
-
-bool AzraelVideo::DontScale() const {
-    return dontScale;
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        AzraelVideo.cpp
+//
+// Author:      David Borland
+//
+// Description: Adds some information about alignment.  Also keeps a few decoded frames, so 
+//              a VideoDecoder thread can decode while the update only picks up the newest.
+//              If the video has a FrameCache, frames come from that instead of the decoder.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////// 
+
+
+#include "AzraelVideo.h"
+
+#include <math.h>
+#include <string.h>
+
+#include <wx/log.h>
+
+
+// One being uploaded, one ready, and one being decoded
+const int AzraelVideo::numberOfFrames = 3;
+
+
+AzraelVideo::AzraelVideo() : VideoFile(), 
+                             frames(numberOfFrames), readyFrames(numberOfFrames), freeFrames(numberOfFrames) {
+    alignType = AzraelImage::None;
+    alignBottom = false;
+
+    dontScale = false;
+
+    for (int i = 0; i < numberOfFrames; i++) {
+        freeFrames.Push(i);
+    }
+    currentFrame = -1;
+
+    playing = false;
+    stopped = true;
+    decodeThread = false;
+
+    frameCache = NULL;
+    loop = false;
+
+    cacheTime = 0.0;
+    lastTicks = 0;
+    lastCacheFrame = -1;
+
+    LARGE_INTEGER f;
+    QueryPerformanceFrequency(&f);
+    frequency = f.QuadPart;
+}
+
+AzraelVideo::~AzraelVideo() {
+    delete frameCache;
+}
+
+
+bool AzraelVideo::OpenFrameCache(const std::string& fileName) {
+    FrameCache* cache = new FrameCache();
+    if (!cache->Open(fileName)) {
+        delete cache;
+        return false;
+    }
+
+    // Has to match what the video decodes to, since the image's texture is made for that
+    int bytesPerPixel = GetVideoType() == VideoStream::RGBA ? 4 : 3;
+    if (cache->GetWidth() != GetWidth() || cache->GetHeight() != GetHeight() || 
+        cache->GetBytesPerPixel() != bytesPerPixel) {
+        wxLogMessage("AzraelVideo::OpenFrameCache() : %s doesn't match the video, decoding instead", fileName.c_str());
+        delete cache;
+        return false;
+    }
+
+    wxCriticalSectionLocker locker(lock);
+
+    delete frameCache;
+    frameCache = cache;
+
+    DropFrames();
+
+    return true;
+}
+
+bool AzraelVideo::HasFrameCache() const {
+    return frameCache != NULL;
+}
+
+
+void AzraelVideo::Play() {
+    // Playing again is called every update, so don't wait on the decoder when there is 
+    // nothing to do
+    if (playing && !stopped) return;
+
+    wxCriticalSectionLocker locker(lock);
+
+    if (frameCache) {
+        // Picks up the clock from where it stopped
+        playing = true;
+        stopped = !loop && cacheTime >= frameCache->GetDuration();
+        lastTicks = 0;
+
+        return;
+    }
+
+    VideoFile::Play();
+
+    playing = true;
+    stopped = VideoFile::IsStopped();
+}
+
+void AzraelVideo::Stop() {
+    wxCriticalSectionLocker locker(lock);
+
+    if (frameCache) {
+        playing = false;
+        stopped = true;
+    }
+    else {
+        VideoFile::Stop();
+
+        playing = false;
+        stopped = VideoFile::IsStopped();
+    }
+
+    DropFrames();
+}
+
+void AzraelVideo::Rewind() {
+    wxCriticalSectionLocker locker(lock);
+
+    if (frameCache) {
+        cacheTime = 0.0;
+        lastCacheFrame = -1;
+        if (playing) stopped = false;
+    }
+    else {
+        VideoFile::Rewind();
+    }
+
+    DropFrames();
+}
+
+void AzraelVideo::Jump(double seconds) {
+    wxCriticalSectionLocker locker(lock);
+
+    if (frameCache) {
+        cacheTime += seconds;
+        if (cacheTime < 0.0) cacheTime = 0.0;
+        lastCacheFrame = -1;
+    }
+    else {
+        VideoFile::Jump(seconds);
+    }
+
+    DropFrames();
+}
+
+bool AzraelVideo::IsStopped() {
+    return stopped;
+}
+
+void AzraelVideo::SetLoop(bool flag) {
+    loop = flag;
+
+    VideoFile::SetLoop(flag);
+}
+
+
+void AzraelVideo::Update() {
+    if (!decodeThread) Decode();
+}
+
+bool AzraelVideo::Decode() {
+    wxCriticalSectionLocker locker(lock);
+
+    if (!playing) return false;
+
+    if (frameCache) return DecodeCache();
+
+    VideoFile::Update();
+
+    stopped = VideoFile::IsStopped();
+    if (stopped) return false;
+
+    // If GetFrame() hasn't kept up, skip this one rather than wait
+    int frame;
+    if (!freeFrames.Pop(frame)) return false;
+
+    unsigned int size = GetWidth() * GetHeight() * (GetVideoType() == VideoStream::RGBA ? 4 : 3);
+    if (frames[frame].size() != size) frames[frame].resize(size);
+
+    memcpy(&frames[frame][0], GetBuffer(), size);
+
+    readyFrames.Push(frame);
+
+    return true;
+}
+
+
+void AzraelVideo::SetDecodeThread(bool flag) {
+    decodeThread = flag;
+}
+
+
+unsigned char* AzraelVideo::GetFrame() {
+    // Only the newest is worth showing
+    int newest = -1;
+    int frame;
+    while (readyFrames.Pop(frame)) {
+        // Cache frame numbers aren't buffers
+        if (newest >= 0 && !frameCache) freeFrames.Push(newest);
+        newest = frame;
+    }
+
+    if (newest < 0) return NULL;
+
+    // Straight from the mapped file
+    if (frameCache) return (unsigned char*)frameCache->GetFrame(newest);
+
+    if (currentFrame >= 0) freeFrames.Push(currentFrame);
+    currentFrame = newest;
+
+    return &frames[currentFrame][0];
+}
+
+
+void AzraelVideo::SetAlignType(AzraelImage::AlignType align) {
+    alignType = align;
+}
+
+void AzraelVideo::SetAlignBottom(bool align) {
+    alignBottom = align;
+}
+
+
+AzraelImage::AlignType AzraelVideo::GetAlignType() const {
+    return alignType;
+}
+
+bool AzraelVideo::GetAlignBottom() const {
+    return alignBottom;
+}
+
+
+void AzraelVideo::SetDontScale(bool flag) {
+    dontScale = flag;
+}
+
+bool AzraelVideo::DontScale() const {
+    return dontScale;
+}
+
+
+bool AzraelVideo::DecodeCache() {
+    // Nothing to decode, just keep the clock
+    LARGE_INTEGER t;
+    QueryPerformanceCounter(&t);
+    if (lastTicks) cacheTime += (double)(t.QuadPart - lastTicks) / frequency;
+    lastTicks = t.QuadPart;
+
+    int frame = (int)(cacheTime * frameCache->GetFramesPerSecond());
+    if (frame >= frameCache->GetNumberOfFrames()) {
+        if (!loop) {
+            stopped = true;
+            return false;
+        }
+
+        cacheTime = fmod(cacheTime, frameCache->GetDuration());
+        frame = (int)(cacheTime * frameCache->GetFramesPerSecond()) % frameCache->GetNumberOfFrames();
+    }
+
+    if (frame == lastCacheFrame) return false;
+
+    // If GetFrame() hasn't kept up, skip this one rather than wait
+    if (!readyFrames.Push(frame)) return false;
+
+    lastCacheFrame = frame;
+
+    return true;
+}
+
+
+void AzraelVideo::DropFrames() {
+    int frame;
+    while (readyFrames.Pop(frame)) {
+        if (!frameCache) freeFrames.Push(frame);
+    }
 }
\ No newline at end of file
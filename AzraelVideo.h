@@ -1,42 +1,109 @@
-///////////////////////////////////////////////////////////////////////////////////////////////
-//
-// Name:        AzraelVideo.h
-//
-// Author:      David Borland
-//
-// Description: Adds some information about alignment.
-//
-/////////////////////////////////////////////////////////////////////////////////////////////// 
-
-
-#ifndef AZRAELVIDEO_H
-#define AZRAELVIDEO_H
-
-
-#include <VideoFile.h>
-
-#include "AzraelImage.h"
-
-
-class AzraelVideo : public VideoFile {
-public:
-    AzraelVideo();
-
-    void SetAlignType(AzraelImage::AlignType align);
-    void SetAlignBottom(bool align);
-
-    AzraelImage::AlignType GetAlignType() const;
-    bool GetAlignBottom() const;
-
-    void SetDontScale(bool flag);
-    bool DontScale() const;
-
-private:
-    AzraelImage::AlignType alignType;
-    bool alignBottom;
-
-    bool dontScale;
-};
-
-
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        AzraelVideo.h
+//
+// Author:      David Borland
+//
+// Description: Adds some information about alignment.  Also keeps a few decoded frames, so 
+//              a VideoDecoder thread can decode while the update only picks up the newest.
+//              If the video has a FrameCache, frames come from that instead of the decoder.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////// 
+
+
+#ifndef AZRAELVIDEO_H
+#define AZRAELVIDEO_H
+
+
+#include <VideoFile.h>
+
+#include <wx/thread.h>
+
+#include <vector>
+
+#include "AzraelImage.h"
+#include "FrameCache.h"
+#include "RingBuffer.h"
+
+
+class AzraelVideo : public VideoFile {
+public:
+    AzraelVideo();
+    ~AzraelVideo();
+
+    // Play from this cache instead of decoding.  Call after Initialize().
+    bool OpenFrameCache(const std::string& fileName);
+    bool HasFrameCache() const;
+
+    // These hide VideoFile's, so a decode thread can safely use the video at the same time
+    void Play();
+    void Stop();
+    void Rewind();
+    void Jump(double seconds);
+    bool IsStopped();
+    void SetLoop(bool flag);
+
+    // Decodes a frame, unless a decode thread is doing that
+    void Update();
+
+    // Decodes a frame into the queue if playing, returning whether it did.  Called from the 
+    // decode thread, or from Update().
+    bool Decode();
+
+    // Set by the VideoDecoder when one of its threads decodes this video
+    void SetDecodeThread(bool flag);
+
+    // The newest frame decoded since the last call, or NULL if there isn't a new one.  Good
+    // until the next call.
+    unsigned char* GetFrame();
+
+    void SetAlignType(AzraelImage::AlignType align);
+    void SetAlignBottom(bool align);
+
+    AzraelImage::AlignType GetAlignType() const;
+    bool GetAlignBottom() const;
+
+    void SetDontScale(bool flag);
+    bool DontScale() const;
+
+private:
+    AzraelImage::AlignType alignType;
+    bool alignBottom;
+
+    bool dontScale;
+
+    // Held while decoding, and while changing what the video is doing
+    wxCriticalSection lock;
+
+    // Frames go from the decoder to GetFrame() through readyFrames, and back through 
+    // freeFrames
+    std::vector<std::vector<unsigned char> > frames;
+    RingBuffer<int> readyFrames;
+    RingBuffer<int> freeFrames;
+    int currentFrame;
+
+    volatile bool playing;
+    volatile bool stopped;
+    bool decodeThread;
+
+    static const int numberOfFrames;
+
+    // When playing from a cache, readyFrames holds frame numbers in it instead, and the 
+    // frame is mapped by GetFrame()
+    FrameCache* frameCache;
+    bool loop;
+
+    // Playback clock for the cache
+    double cacheTime;
+    LONGLONG lastTicks;
+    LONGLONG frequency;
+    int lastCacheFrame;
+
+    bool DecodeCache();
+
+    // Called from the consumer side, e.g. after rewinding, so an old frame isn't shown
+    void DropFrames();
+};
+
+
 #endif
\ No newline at end of file
@@ -0,0 +1,600 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        Benchmark.cpp
+//
+// Author:      David Borland
+//
+// Description: Micro-benchmarks for the CPU side of Azrael, run with --benchmark instead of 
+//              starting the installation.  The blur benchmarks need an OpenGL context and are
+//              run separately with --blurbenchmark, and the video benchmarks, which need the
+//              videos and their frame caches, with --videobenchmark.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "Benchmark.h"
+
+#include "Tracking.h"
+#include "ViewerGrid.h"
+#include "Random.h"
+#include "TaskPool.h"
+#include "ImageTasks.h"
+#include "QuadrantImage.h"
+#include "BlurKernel.h"
+#include "BlurShaders.h"
+#include "BlurTargetCache.h"
+#include "FrameCache.h"
+
+#include <VideoFile.h>
+
+#include <algorithm>
+#include <vector>
+#include <sstream>
+#include <stdlib.h>
+#include <string.h>
+
+#include <wx/log.h>
+#include <wx/stopwatch.h>
+
+
+// The original implementation of Tracking::GetAverageDistance, for comparison
+static float SortedAverageDistance(const Tracking& tracking, const Vec2& position, int n) {
+    std::vector<float> distances;
+
+    for (int i = 0; i < tracking.GetNumberOfViewers(); i++) {
+        Vec2 viewerPos = tracking.GetViewer(i)->GetPosition();
+        distances.push_back((viewerPos - position).Magnitude());
+    }
+
+    if (n > 0 && n < tracking.GetNumberOfViewers()) {
+        sort(distances.begin(), distances.end());
+    }
+    else {
+        n = tracking.GetNumberOfViewers();
+    }
+
+    float average = 0.0;
+    for (int i = 0; i < n; i++) {
+        average += distances[i];
+    }
+    average /= n;
+
+    return average;
+}
+
+
+// Moves a random viewer a small step, as a tracker sample would
+static int WalkCrowd(std::vector<Vec2>& crowd, timeval& t) {
+    int index = Random::Int() % (int)crowd.size();
+
+    Vec2& p = crowd[index];
+    p.X() = std::min(6.4f, std::max(0.1f, (float)p.X() + (Random::Float() - 0.5f) * 0.1f));
+    p.Y() = std::min(6.4f, std::max(0.1f, (float)p.Y() + (Random::Float() - 0.5f) * 0.1f));
+
+    t.tv_usec += 1000;
+    if (t.tv_usec >= 1000000) {
+        t.tv_sec++;
+        t.tv_usec -= 1000000;
+    }
+
+    return index;
+}
+
+
+// Fills tracking with a crowd of viewers at random positions
+static void CreateCrowd(Tracking& tracking, int numViewers) {
+    tracking.SetRoomExtents(Vec2(0.0, 0.0), Vec2(6.5, 6.5));
+
+    timeval t;
+    t.tv_sec = 0;
+    t.tv_usec = 0;
+
+    for (int i = 0; i < numViewers; i++) {
+        Vec3 p(Random::Float() * 6.5, Random::Float() * 6.5, 1.5);
+        tracking.UpdateViewer(i, p, t);
+    }
+}
+
+
+Benchmark::Benchmark() {
+}
+
+Benchmark::~Benchmark() {
+    results.close();
+}
+
+
+bool Benchmark::Run(const std::string& fileName) {
+    if (!OpenResults(fileName)) return false;
+
+    AverageDistance();
+    ClosestDistance();
+    ParallelImageUpdate();
+
+    return true;
+}
+
+bool Benchmark::RunBlur(const std::string& fileName) {
+    if (!OpenResults(fileName)) return false;
+
+    BlurCPU();
+    BlurGPU();
+
+    return true;
+}
+
+bool Benchmark::RunVideo(const std::string& fileName) {
+    if (!OpenResults(fileName)) return false;
+
+    VideoCache();
+
+    return true;
+}
+
+
+bool Benchmark::OpenResults(const std::string& fileName) {
+    results.open(fileName.c_str(), std::fstream::out);
+    if (results.fail()) {
+        wxLogMessage("Benchmark::OpenResults() : Couldn't open %s", fileName.c_str());
+        return false;
+    }
+
+    // Same numbers every run
+    Random::Seed(1);
+
+    results << "# name size milliseconds iterations microsecondsPerIteration" << std::endl;
+
+    return true;
+}
+
+
+void Benchmark::AverageDistance() {
+    const int numImages = 40;
+    const int numToAverage = 3;
+    const int iterations = 10000;
+
+    int crowdSizes[] = { 10, 30, 50, 100 };
+    for (int c = 0; c < 4; c++) {
+        Tracking tracking;
+        CreateCrowd(tracking, crowdSizes[c]);
+
+        std::vector<Vec2> positions(numImages);
+        for (int i = 0; i < numImages; i++) {
+            positions[i] = Vec2(Random::Float() * 6.5, 6.5);
+        }
+
+        std::vector<float> averages(numImages);
+        float sum = 0.0;
+
+        // Sort per call, as Engine::UpdateNormal used to
+        wxStopWatch watch;
+        for (int j = 0; j < iterations; j++) {
+            for (int i = 0; i < numImages; i++) {
+                averages[i] = SortedAverageDistance(tracking, positions[i], numToAverage);
+            }
+            sum += averages[0];
+        }
+        WriteResult("AverageDistanceSorted", crowdSizes[c], watch.Time(), iterations);
+
+        // Per call grid query
+        watch.Start();
+        for (int j = 0; j < iterations; j++) {
+            for (int i = 0; i < numImages; i++) {
+                averages[i] = tracking.GetAverageDistance(positions[i], numToAverage);
+            }
+            sum += averages[0];
+        }
+        WriteResult("AverageDistanceGrid", crowdSizes[c], watch.Time(), iterations);
+
+        // Batched top-k selection
+        watch.Start();
+        for (int j = 0; j < iterations; j++) {
+            tracking.GetAverageDistances(positions, numToAverage, averages);
+            sum += averages[0];
+        }
+        WriteResult("AverageDistanceBatched", crowdSizes[c], watch.Time(), iterations);
+
+        // Keep the compiler from optimizing the work away
+        if (sum < 0.0) wxLogMessage("");
+    }
+}
+
+
+void Benchmark::ClosestDistance() {
+    const int iterations = 100000;
+
+    int crowdSizes[] = { 10, 30, 50, 100 };
+    for (int c = 0; c < 4; c++) {
+        int numViewers = crowdSizes[c];
+
+        std::vector<Vec2> start(numViewers);
+        for (int i = 0; i < numViewers; i++) {
+            start[i] = Vec2(Random::Float() * 6.5, Random::Float() * 6.5);
+        }
+
+        timeval t;
+        float sum = 0.0;
+
+        // Scan all other viewers for every sample, as Tracking::UpdateViewer originally did
+        std::vector<Vec2> crowd = start;
+        t.tv_sec = t.tv_usec = 0;
+        wxStopWatch watch;
+        for (int j = 0; j < iterations; j++) {
+            int index = WalkCrowd(crowd, t);
+
+            float closest = 10.0;
+            for (int i = 0; i < numViewers; i++) {
+                if (i == index) continue;
+
+                float distance = (crowd[i] - crowd[index]).Magnitude();
+                if (distance < closest) closest = distance;
+            }
+            sum += closest;
+        }
+        WriteResult("ClosestDistanceScan", numViewers, watch.Time(), iterations);
+
+        // Grid query for every sample
+        crowd = start;
+        t.tv_sec = t.tv_usec = 0;
+        ViewerGrid grid;
+        grid.SetExtents(Vec2(0.0, 0.0), Vec2(6.5, 6.5));
+        for (int i = 0; i < numViewers; i++) {
+            grid.Insert(i, crowd[i]);
+        }
+        watch.Start();
+        for (int j = 0; j < iterations; j++) {
+            int index = WalkCrowd(crowd, t);
+
+            float closest = 10.0;
+            float distance;
+            if (grid.KNearest(crowd[index], 1, &distance, index) > 0 && distance < closest) {
+                closest = distance;
+            }
+            sum += closest;
+
+            grid.Move(index, crowd[index]);
+        }
+        WriteResult("ClosestDistanceGrid", numViewers, watch.Time(), iterations);
+
+        // The full Tracking::UpdateViewer path, which uses the grid query
+        crowd = start;
+        t.tv_sec = t.tv_usec = 0;
+        Tracking tracking;
+        tracking.SetRoomExtents(Vec2(0.0, 0.0), Vec2(6.5, 6.5));
+        for (int i = 0; i < numViewers; i++) {
+            tracking.UpdateViewer(i, Vec3(crowd[i].X(), crowd[i].Y(), 1.5), t);
+        }
+        watch.Start();
+        for (int j = 0; j < iterations; j++) {
+            int index = WalkCrowd(crowd, t);
+
+            tracking.UpdateViewer(index, Vec3(crowd[index].X(), crowd[index].Y(), 1.5), t);
+        }
+        WriteResult("ClosestDistanceUpdateViewer", numViewers, watch.Time(), iterations);
+
+        sum += tracking.GetViewer(0)->GetAverageClosestDistance();
+
+        // Keep the compiler from optimizing the work away
+        if (sum < 0.0) wxLogMessage("");
+    }
+}
+
+
+void Benchmark::ParallelImageUpdate() {
+    const int numViewers = 100;
+    const int numToAverage = 3;
+    const int iterations = 1000;
+
+    // Same as Engine
+    const int distanceGrain = 64;
+    const int imageUpdateGrain = 512;
+
+    Tracking tracking;
+    CreateCrowd(tracking, numViewers);
+
+    int maxThreads = wxThread::GetCPUCount();
+    if (maxThreads < 1) maxThreads = 1;
+
+    int imageCounts[] = { 40, 200, 1000, 5000 };
+    for (int c = 0; c < 4; c++) {
+        int numImages = imageCounts[c];
+
+        std::vector<AzraelImage*> images;
+        std::vector<Vec2> wallPositions(numImages);
+        for (int i = 0; i < numImages; i++) {
+            images.push_back(new QuadrantImage());
+            images[i]->SetPosition(Vec2(Random::Float() * 6.5, Random::Float()));
+            images[i]->SetDesiredPosition(Vec2(Random::Float() * 6.5, Random::Float()));
+            images[i]->Fade();
+
+            wallPositions[i] = Vec2(Random::Float() * 6.5, 6.5);
+        }
+        std::vector<float> distances(numImages);
+
+        // 1, 2, 4, ... threads, and all of them
+        for (int numThreads = 1; ; numThreads *= 2) {
+            if (numThreads > maxThreads) numThreads = maxThreads;
+
+            TaskPool pool(numThreads);
+            std::vector<std::vector<float> > scratch(pool.GetNumberOfThreads());
+
+            std::stringstream threads;
+            threads << pool.GetNumberOfThreads();
+
+            ImageDistanceTask distanceTask(&images[0], &tracking, numToAverage, wallPositions, distances, scratch);
+            wxStopWatch watch;
+            for (int j = 0; j < iterations; j++) {
+                pool.ParallelFor(distanceTask, numImages, distanceGrain);
+            }
+            WriteResult("ParallelImageDistance" + threads.str(), numImages, watch.Time(), iterations);
+
+            ImageUpdateTask updateTask(&images[0], 0.01);
+            watch.Start();
+            for (int j = 0; j < iterations; j++) {
+                pool.ParallelFor(updateTask, numImages, imageUpdateGrain);
+            }
+            WriteResult("ParallelImageUpdate" + threads.str(), numImages, watch.Time(), iterations);
+
+            if (numThreads == maxThreads) break;
+        }
+
+        for (int i = 0; i < numImages; i++) {
+            delete images[i];
+        }
+    }
+}
+
+
+// The blur benchmarks use a 1024 x 1024 image, so an iteration is one (binary) megapixel, 
+// and the size written is the blur radius
+static const int blurImageSize = 1024;
+static const unsigned int blurRadii[] = { 2, 4, 8, 16 };
+static const int numBlurRadii = 4;
+
+
+// Random RGBA pixels
+static void CreateBlurImage(std::vector<unsigned char>& image) {
+    image.resize(blurImageSize * blurImageSize * 4);
+    for (int i = 0; i < (int)image.size(); i++) {
+        image[i] = (unsigned char)(Random::Int() % 256);
+    }
+}
+
+static int MaxDifference(const std::vector<unsigned char>& a, const std::vector<unsigned char>& b) {
+    int maxDifference = 0;
+    for (int i = 0; i < (int)a.size(); i++) {
+        int difference = abs((int)a[i] - (int)b[i]);
+        if (difference > maxDifference) maxDifference = difference;
+    }
+
+    return maxDifference;
+}
+
+
+void Benchmark::BlurCPU() {
+    const int iterations = 3;
+
+    std::vector<unsigned char> source;
+    CreateBlurImage(source);
+
+    std::vector<unsigned char> temp(source.size());
+    std::vector<unsigned char> reference(source.size());
+    std::vector<unsigned char> linear(source.size());
+
+    for (int r = 0; r < numBlurRadii; r++) {
+        unsigned int radius = blurRadii[r];
+
+        // One fetch per texel
+        wxStopWatch watch;
+        for (int i = 0; i < iterations; i++) {
+            BlurKernel::Blur(&source[0], &temp[0], &reference[0], blurImageSize, blurImageSize, 4, radius, false);
+        }
+        WriteResult("BlurTapsCPU", radius, watch.Time(), iterations);
+
+        // Merged taps
+        watch.Start();
+        for (int i = 0; i < iterations; i++) {
+            BlurKernel::Blur(&source[0], &temp[0], &linear[0], blurImageSize, blurImageSize, 4, radius, true);
+        }
+        WriteResult("BlurLinearCPU", radius, watch.Time(), iterations);
+
+        wxLogMessage("Benchmark::BlurCPU() : Radius %u, linear sampling differs from the reference by up to %d", 
+                     radius, MaxDifference(reference, linear));
+    }
+}
+
+void Benchmark::BlurGPU() {
+    const int iterations = 20;
+
+    GLenum err = glewInit();
+    if (GLEW_OK != err) {
+        wxLogMessage("Benchmark::BlurGPU() : %s", glewGetErrorString(err));
+        return;
+    }
+    if (!GLEW_ARB_texture_rectangle || !GLEW_EXT_framebuffer_object || !GLEW_ARB_shading_language_100) {
+        wxLogMessage("Benchmark::BlurGPU() : Missing OpenGL extensions, skipping");
+        return;
+    }
+
+    // Worth knowing whether this is the card or a software rasterizer
+    wxLogMessage("Benchmark::BlurGPU() : %s %s", glGetString(GL_VENDOR), glGetString(GL_RENDERER));
+
+    std::vector<unsigned char> source;
+    CreateBlurImage(source);
+
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_RECTANGLE_ARB, texture);
+    glTexParameteri(GL_TEXTURE_RECTANGLE_ARB, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_RECTANGLE_ARB, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_RECTANGLE_ARB, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_RECTANGLE_ARB, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_RECTANGLE_ARB, 0, GL_RGBA, blurImageSize, blurImageSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, &source[0]);
+
+    BlurShaders tapShaders;
+    BlurShaders linearShaders;
+    if (!tapShaders.Initialize(AzraelImage::GetMaxBlurRadius(), false) ||
+        !linearShaders.Initialize(AzraelImage::GetMaxBlurRadius(), true)) {
+        wxLogMessage("Benchmark::BlurGPU() : Couldn't create blur programs");
+        glDeleteTextures(1, &texture);
+        return;
+    }
+
+    BlurTargetCache targets;
+    BlurTarget* target = targets.Acquire(blurImageSize, blurImageSize, Image::RGBA);
+
+    std::vector<unsigned char> temp(source.size());
+    std::vector<unsigned char> reference(source.size());
+    std::vector<unsigned char> result(source.size());
+
+    for (int r = 0; r < numBlurRadii; r++) {
+        unsigned int radius = blurRadii[r];
+
+        BlurKernel::Blur(&source[0], &temp[0], &reference[0], blurImageSize, blurImageSize, 4, radius, false);
+
+        for (int s = 0; s < 3; s++) {
+            BlurShaders& shaders = s == 0 ? tapShaders : linearShaders;
+            std::string name = s == 0 ? "BlurTapsGPU" : (s == 1 ? "BlurLinearGPU" : "BlurPyramidGPU");
+
+            // The pyramid blurs small radii at full resolution, so only matches the reference
+            // for those
+            shaders.SetMode(s == 2 ? BlurShaders::Pyramid : BlurShaders::Box);
+
+            // Once to warm up, and to check against the CPU
+            shaders.Blur(texture, target, blurImageSize, blurImageSize, radius);
+
+            glBindTexture(GL_TEXTURE_RECTANGLE_ARB, target->finalTexture);
+            glGetTexImage(GL_TEXTURE_RECTANGLE_ARB, 0, GL_RGBA, GL_UNSIGNED_BYTE, &result[0]);
+
+            wxLogMessage("Benchmark::BlurGPU() : %s radius %u differs from the CPU reference by up to %d", 
+                         name.c_str(), radius, MaxDifference(reference, result));
+
+            wxStopWatch watch;
+            for (int i = 0; i < iterations; i++) {
+                shaders.Blur(texture, target, blurImageSize, blurImageSize, radius);
+            }
+            glFinish();
+            WriteResult(name, radius, watch.Time(), iterations);
+        }
+    }
+
+    targets.Release(target);
+
+    glDeleteTextures(1, &texture);
+}
+
+
+// The video benchmarks write one result per video, named after it, with the frame size in 
+// kilobytes as the size and one iteration per frame
+void Benchmark::VideoCache() {
+    // Seconds of each video to decode.  VideoFile decodes in real time, so this is how long 
+    // the benchmark takes per video.
+    const double decodeSeconds = 2.0;
+
+    std::vector<std::string> videoNames;
+    if (!FrameCache::ReadVideoNames("Media/VideoInfo.txt", videoNames)) return;
+
+    LARGE_INTEGER t;
+    QueryPerformanceFrequency(&t);
+    double ticksPerMillisecond = t.QuadPart / 1000.0;
+
+    double totalDecode = 0.0;
+    int totalDecodeFrames = 0;
+    double totalRead = 0.0;
+    int totalReadFrames = 0;
+    int totalRepeats = 0;
+    double totalReadBytes = 0.0;
+
+    for (int i = 0; i < (int)videoNames.size(); i++) {
+        FrameCache cache;
+        if (!cache.Open(FrameCache::GetFileName(videoNames[i]))) {
+            wxLogMessage("Benchmark::VideoCache() : No frame cache for %s, run with --framecache first", videoNames[i].c_str());
+            continue;
+        }
+
+        VideoFile video;
+        video.SetName(videoNames[i]);
+        if (!video.Initialize(VideoStream::RGBA)) {
+            wxLogMessage("Benchmark::VideoCache() : Couldn't open %s", videoNames[i].c_str());
+            continue;
+        }
+        video.SetLoop(true);
+
+        // Video name without the directory or extension
+        std::string name = videoNames[i];
+        std::string::size_type slash = name.find_last_of("/\\");
+        if (slash != std::string::npos) name.erase(0, slash + 1);
+        std::string::size_type extension = name.rfind('.');
+        if (extension != std::string::npos) name.erase(extension);
+
+        int frameKilobytes = cache.GetFrameSize() / 1024;
+
+        // Time spent in Update() while playing, per frame shown at the cache's frame rate
+        LONGLONG decodeTicks = 0;
+        video.Play();
+        wxStopWatch watch;
+        while (watch.Time() < decodeSeconds * 1000.0) {
+            QueryPerformanceCounter(&t);
+            LONGLONG start = t.QuadPart;
+
+            video.Update();
+
+            QueryPerformanceCounter(&t);
+            decodeTicks += t.QuadPart - start;
+
+            Sleep(1);
+        }
+        video.Stop();
+
+        double decodeMilliseconds = decodeTicks / ticksPerMillisecond;
+        int decodeFrames = (int)(decodeSeconds * cache.GetFramesPerSecond());
+        WriteResult("VideoDecode_" + name, frameKilobytes, decodeMilliseconds, decodeFrames);
+
+        // Every frame stored in the mapped file, copied as AzraelImage copies it into a 
+        // pixel buffer.  Repeats reuse the view already mapped, so would only measure the
+        // copy, and are counted separately.  Not necessarily cold, if the cache was read 
+        // recently.
+        std::vector<unsigned char> upload(cache.GetFrameSize());
+        int readFrames = 0;
+        int repeats = 0;
+        QueryPerformanceCounter(&t);
+        LONGLONG start = t.QuadPart;
+        for (int j = 0; j < cache.GetNumberOfFrames(); j++) {
+            if (cache.IsRepeat(j)) {
+                repeats++;
+                continue;
+            }
+
+            const unsigned char* frame = cache.GetFrame(j);
+            if (!frame) break;
+
+            memcpy(&upload[0], frame, upload.size());
+            readFrames++;
+        }
+        QueryPerformanceCounter(&t);
+
+        double readMilliseconds = (t.QuadPart - start) / ticksPerMillisecond;
+        WriteResult("VideoCacheRead_" + name, frameKilobytes, readMilliseconds, readFrames);
+
+        totalDecode += decodeMilliseconds;
+        totalDecodeFrames += decodeFrames;
+        totalRead += readMilliseconds;
+        totalReadFrames += readFrames;
+        totalRepeats += repeats;
+        totalReadBytes += (double)readFrames * upload.size();
+    }
+
+    if (totalDecodeFrames > 0 && totalReadFrames > 0) {
+        wxLogMessage("Benchmark::VideoCache() : Decoding took %.3f ms per frame, reading the caches %.3f ms per frame (%.0f MB/s)",
+                     totalDecode / totalDecodeFrames, totalRead / totalReadFrames, 
+                     totalReadBytes / (1024.0 * 1024.0) / (totalRead / 1000.0));
+
+        wxLogMessage("Benchmark::VideoCache() : %d more frames were repeats, stored and mapped once", totalRepeats);
+    }
+}
+
+
+void Benchmark::WriteResult(const std::string& name, int size, double milliseconds, int iterations) {
+    results << name << " " << size << " " << milliseconds << " " << iterations << " " 
+            << milliseconds * 1000.0 / iterations << std::endl;
+}
\ No newline at end of file
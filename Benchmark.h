@@ -0,0 +1,54 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        Benchmark.h
+//
+// Author:      David Borland
+//
+// Description: Micro-benchmarks for the CPU side of Azrael, run with --benchmark instead of 
+//              starting the installation.  The blur benchmarks need an OpenGL context and are
+//              run separately with --blurbenchmark, and the video benchmarks, which need the
+//              videos and their frame caches, with --videobenchmark.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+
+#include <string>
+#include <fstream>
+
+
+class Benchmark {
+public:
+    Benchmark();
+    ~Benchmark();
+
+    // Runs all benchmarks, writing the results to the given file
+    bool Run(const std::string& fileName);
+
+    // Runs the blur benchmarks.  An OpenGL context must be current.
+    bool RunBlur(const std::string& fileName);
+
+    // Compares decoding the videos in Media/VideoInfo.txt with reading their frame caches,
+    // written with --framecache
+    bool RunVideo(const std::string& fileName);
+
+private:
+    std::fstream results;
+
+    void AverageDistance();
+    void ClosestDistance();
+    void ParallelImageUpdate();
+    void BlurCPU();
+    void BlurGPU();
+    void VideoCache();
+
+    bool OpenResults(const std::string& fileName);
+
+    void WriteResult(const std::string& name, int size, double milliseconds, int iterations);
+};
+
+
+#endif
\ No newline at end of file
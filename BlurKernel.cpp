@@ -0,0 +1,141 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        BlurKernel.cpp
+//
+// Author:      David Borland
+//
+// Description: Taps for the separable box blur.  Neighbouring taps are merged into one
+//              fetch between them, letting linear texture filtering do the weighting, so a
+//              pass takes radius + 1 fetches instead of 2 * radius + 1.  Generates the GLSL
+//              for each radius with the taps as constants, and blurs on the CPU the same way
+//              for checking the shaders and comparing cost.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "BlurKernel.h"
+
+#include <math.h>
+#include <iomanip>
+#include <sstream>
+
+
+void BlurKernel::Taps(unsigned int radius, bool linearSampling, std::vector<BlurTap>& taps) {
+    taps.clear();
+
+    float weight = 1.0f / (2 * radius + 1);
+
+    BlurTap center;
+    center.offset = 0.0f;
+    center.weight = weight;
+    taps.push_back(center);
+
+    // Equal weights, so a merged tap sits halfway between the two texels it replaces
+    unsigned int i = 1;
+    while (i <= radius) {
+        BlurTap tap;
+        if (linearSampling && i + 1 <= radius) {
+            tap.offset = i + 0.5f;
+            tap.weight = 2.0f * weight;
+            i += 2;
+        }
+        else {
+            tap.offset = (float)i;
+            tap.weight = weight;
+            i++;
+        }
+
+        taps.push_back(tap);
+
+        tap.offset = -tap.offset;
+        taps.push_back(tap);
+    }
+}
+
+
+std::string BlurKernel::ShaderSource(unsigned int radius, bool horizontal, bool linearSampling) {
+    std::vector<BlurTap> taps;
+    Taps(radius, linearSampling, taps);
+
+    std::stringstream source;
+    source << std::fixed << std::setprecision(8);
+
+    source << "uniform sampler2DRect image;\n"
+           << "\n"
+           << "void main() {\n"
+           << "\tvec4 outColor = vec4(0.0);\n";
+
+    for (int i = 0; i < (int)taps.size(); i++) {
+        float x = horizontal ? taps[i].offset : 0.0f;
+        float y = horizontal ? 0.0f : taps[i].offset;
+
+        source << "\toutColor += texture2DRect(image, gl_TexCoord[0].st + vec2("
+               << x << ", " << y << ")) * " << taps[i].weight << ";\n";
+    }
+
+    source << "\n"
+           << "\tgl_FragColor = outColor;\n"
+           << "}\n";
+
+    return source.str();
+}
+
+
+void BlurKernel::Pass(const unsigned char* source, unsigned char* destination,
+                      int width, int height, int channels,
+                      const std::vector<BlurTap>& taps, bool horizontal) {
+    int numTaps = (int)taps.size();
+
+    // Split each offset into a whole texel step and a fraction toward the next texel
+    std::vector<int> steps(numTaps);
+    std::vector<float> fractions(numTaps);
+    for (int i = 0; i < numTaps; i++) {
+        float step = floor(taps[i].offset);
+        steps[i] = (int)step;
+        fractions[i] = taps[i].offset - step;
+    }
+
+    // Walk along rows or columns
+    int length = horizontal ? width : height;
+    int lines = horizontal ? height : width;
+    int stride = horizontal ? channels : width * channels;
+    int lineStride = horizontal ? width * channels : channels;
+
+    for (int line = 0; line < lines; line++) {
+        const unsigned char* in = source + line * lineStride;
+        unsigned char* out = destination + line * lineStride;
+
+        for (int i = 0; i < length; i++) {
+            for (int c = 0; c < channels; c++) {
+                float value = 0.0f;
+
+                for (int t = 0; t < numTaps; t++) {
+                    int i0 = i + steps[t];
+                    int i1 = i0 + 1;
+
+                    if (i0 < 0) i0 = 0;
+                    else if (i0 >= length) i0 = length - 1;
+                    if (i1 < 0) i1 = 0;
+                    else if (i1 >= length) i1 = length - 1;
+
+                    float f = fractions[t];
+                    float sample = in[i0 * stride + c] * (1.0f - f) + in[i1 * stride + c] * f;
+
+                    value += sample * taps[t].weight;
+                }
+
+                out[i * stride + c] = (unsigned char)(value + 0.5f);
+            }
+        }
+    }
+}
+
+void BlurKernel::Blur(const unsigned char* source, unsigned char* temp, unsigned char* destination,
+                      int width, int height, int channels,
+                      unsigned int radius, bool linearSampling) {
+    std::vector<BlurTap> taps;
+    Taps(radius, linearSampling, taps);
+
+    Pass(source, temp, width, height, channels, taps, true);
+    Pass(temp, destination, width, height, channels, taps, false);
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        BlurKernel.h
+//
+// Author:      David Borland
+//
+// Description: Taps for the separable box blur.  Neighbouring taps are merged into one
+//              fetch between them, letting linear texture filtering do the weighting, so a
+//              pass takes radius + 1 fetches instead of 2 * radius + 1.  Generates the GLSL
+//              for each radius with the taps as constants, and blurs on the CPU the same way
+//              for checking the shaders and comparing cost.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef BLURKERNEL_H
+#define BLURKERNEL_H
+
+
+#include <string>
+#include <vector>
+
+
+// A fetch at offset texels from the center, scaled by weight
+struct BlurTap {
+    float offset;
+    float weight;
+};
+
+
+class BlurKernel {
+public:
+    // Taps for one pass of a box blur with the given radius.  With linearSampling, pairs of
+    // taps are merged for fetching with linear filtering.
+    static void Taps(unsigned int radius, bool linearSampling, std::vector<BlurTap>& taps);
+
+    // Fragment shader for one pass, reading from a sampler2DRect called image
+    static std::string ShaderSource(unsigned int radius, bool horizontal, bool linearSampling);
+
+    // One pass over an interleaved 8-bit image, clamping at the edges like the textures do.
+    // Taps at fractional offsets are interpolated, as linear filtering would.
+    static void Pass(const unsigned char* source, unsigned char* destination,
+                     int width, int height, int channels,
+                     const std::vector<BlurTap>& taps, bool horizontal);
+
+    // Both passes, using temp for the intermediate image
+    static void Blur(const unsigned char* source, unsigned char* temp, unsigned char* destination,
+                     int width, int height, int channels,
+                     unsigned int radius, bool linearSampling);
+};
+
+
+#endif
\ No newline at end of file
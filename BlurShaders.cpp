@@ -0,0 +1,266 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        BlurShaders.cpp
+//
+// Author:      David Borland
+//
+// Description: Fragment programs for the two blur passes, one pair for each radius, with
+//              the taps compiled in.  Also draws the passes into a BlurTarget, either at full
+//              resolution or, for large radii, at a reduced resolution and scaled back up.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "BlurShaders.h"
+
+#include "BlurKernel.h"
+
+#include <wx/log.h>
+
+
+const unsigned int BlurShaders::pyramidRadius = 4;
+
+
+static const char* copySource =
+    "uniform sampler2DRect image;\n"
+    "\n"
+    "void main() {\n"
+    "\tgl_FragColor = texture2DRect(image, gl_TexCoord[0].st);\n"
+    "}\n";
+
+
+BlurShaders::BlurShaders() {
+    copyProgram = 0;
+    linear = true;
+    mode = Box;
+}
+
+BlurShaders::~BlurShaders() {
+    for (int i = 0; i < (int)horizontalPrograms.size(); i++) {
+        glDeleteObjectARB(horizontalPrograms[i]);
+    }
+
+    for (int i = 0; i < (int)verticalPrograms.size(); i++) {
+        glDeleteObjectARB(verticalPrograms[i]);
+    }
+
+    if (copyProgram) glDeleteObjectARB(copyProgram);
+}
+
+
+bool BlurShaders::Initialize(unsigned int maxRadius, bool linearSampling) {
+    linear = linearSampling;
+
+    for (unsigned int radius = 1; radius <= maxRadius; radius++) {
+        GLhandleARB program;
+
+        if (!CreateProgram(BlurKernel::ShaderSource(radius, true, linear), program)) {
+            wxLogMessage("BlurShaders::Initialize() : Could not create horizontal blur program for radius %u", radius);
+            return false;
+        }
+        horizontalPrograms.push_back(program);
+
+        if (!CreateProgram(BlurKernel::ShaderSource(radius, false, linear), program)) {
+            wxLogMessage("BlurShaders::Initialize() : Could not create vertical blur program for radius %u", radius);
+            return false;
+        }
+        verticalPrograms.push_back(program);
+    }
+
+    if (!CreateProgram(copySource, copyProgram)) {
+        wxLogMessage("BlurShaders::Initialize() : Could not create copy program");
+        return false;
+    }
+
+    return true;
+}
+
+
+unsigned int BlurShaders::GetMaxRadius() const {
+    return (unsigned int)horizontalPrograms.size();
+}
+
+
+void BlurShaders::SetMode(Mode blurMode) {
+    mode = blurMode;
+}
+
+BlurShaders::Mode BlurShaders::GetMode() const {
+    return mode;
+}
+
+
+void BlurShaders::Blur(GLuint texture, BlurTarget* target, unsigned int width, unsigned int height,
+                       unsigned int radius, unsigned int x, unsigned int y) const {
+    if (radius < 1) return;
+    if (radius > GetMaxRadius()) radius = GetMaxRadius();
+
+    // Each level down halves the radius
+    int numLevels = 0;
+    if (mode == Pyramid) {
+        while (radius > pyramidRadius) {
+            radius = (radius + 1) / 2;
+            numLevels++;
+        }
+    }
+
+    // Setup for all passes
+    glPushAttrib(GL_VIEWPORT_BIT | GL_COLOR_BUFFER_BIT);
+
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    glOrtho(0.0, 1.0, 0.0, 1.0, -1.0, 1.0);
+
+    // Merged taps and scaling fall between texels, so the source has to be filtered
+    if (linear || numLevels > 0) {
+        glBindTexture(GL_TEXTURE_RECTANGLE_ARB, texture);
+        glTexParameteri(GL_TEXTURE_RECTANGLE_ARB, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_RECTANGLE_ARB, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
+
+
+    if (numLevels == 0) {
+        glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, target->fbo);
+        glViewport(0, 0, width, height);
+
+        DoPasses(texture, (float)x, (float)y, target->tempTexture, GL_COLOR_ATTACHMENT0_EXT, GL_COLOR_ATTACHMENT1_EXT,
+                 width, height, radius);
+    }
+    else {
+        BlurTargetCache::CreateLevels(target, numLevels);
+
+        // Scale down, sampling between each 2x2 block so linear filtering averages it
+        glUseProgramObjectARB(copyProgram);
+
+        GLuint source = texture;
+        float sourceX = (float)x;
+        float sourceY = (float)y;
+        for (int i = 0; i < numLevels; i++) {
+            const BlurLevel& level = target->levels[i];
+
+            glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, level.fbo);
+            glViewport(0, 0, level.width, level.height);
+            glDrawBuffer(GL_COLOR_ATTACHMENT0_EXT);
+
+            glBindTexture(GL_TEXTURE_RECTANGLE_ARB, source);
+            DrawQuad(sourceX, sourceY, (float)level.width * 2.0f, (float)level.height * 2.0f);
+
+            source = level.texture;
+            sourceX = 0.0f;
+            sourceY = 0.0f;
+        }
+
+
+        // Blur the smallest level in place
+        const BlurLevel& bottom = target->levels[numLevels - 1];
+
+        DoPasses(bottom.texture, 0.0f, 0.0f, bottom.tempTexture, GL_COLOR_ATTACHMENT1_EXT, GL_COLOR_ATTACHMENT0_EXT,
+                 bottom.width, bottom.height, radius);
+
+
+        // Scale back up in one step
+        glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, target->fbo);
+        glViewport(0, 0, width, height);
+        glDrawBuffer(GL_COLOR_ATTACHMENT1_EXT);
+
+        glUseProgramObjectARB(copyProgram);
+        glBindTexture(GL_TEXTURE_RECTANGLE_ARB, bottom.texture);
+
+        float scale = 1.0f / (1 << numLevels);
+        DrawQuad(0.0f, 0.0f, width * scale, height * scale);
+    }
+
+
+    // Restore state
+    glPopMatrix();
+
+    glPopAttrib();
+    glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, 0);
+
+    glUseProgramObjectARB(0);
+}
+
+
+void BlurShaders::DoPasses(GLuint source, float x, float y, GLuint temp, GLenum tempBuffer, GLenum destinationBuffer,
+                           unsigned int width, unsigned int height, unsigned int radius) const {
+    // Horizontal blur
+    glDrawBuffer(tempBuffer);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    glBindTexture(GL_TEXTURE_RECTANGLE_ARB, source);
+
+    glUseProgramObjectARB(horizontalPrograms[radius - 1]);
+
+    DrawQuad(x, y, (float)width, (float)height);
+
+
+    // Vertical blur
+    glDrawBuffer(destinationBuffer);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    glBindTexture(GL_TEXTURE_RECTANGLE_ARB, temp);
+
+    glUseProgramObjectARB(verticalPrograms[radius - 1]);
+
+    DrawQuad(0.0f, 0.0f, (float)width, (float)height);
+}
+
+
+bool BlurShaders::CreateProgram(const std::string& source, GLhandleARB& program) {
+    GLhandleARB shader = glCreateShaderObjectARB(GL_FRAGMENT_SHADER_ARB);
+
+    const GLcharARB* text = source.c_str();
+    glShaderSourceARB(shader, 1, &text, NULL);
+    glCompileShaderARB(shader);
+
+    GLint compiled;
+    glGetObjectParameterivARB(shader, GL_OBJECT_COMPILE_STATUS_ARB, &compiled);
+    if (!compiled) {
+        GLcharARB log[1024];
+        glGetInfoLogARB(shader, sizeof(log), NULL, log);
+        wxLogMessage("BlurShaders::CreateProgram() : %s", log);
+
+        glDeleteObjectARB(shader);
+        return false;
+    }
+
+    program = glCreateProgramObjectARB();
+    glAttachObjectARB(program, shader);
+    glLinkProgramARB(program);
+
+    // The program keeps the shader until the program is deleted
+    glDeleteObjectARB(shader);
+
+    GLint linked;
+    glGetObjectParameterivARB(program, GL_OBJECT_LINK_STATUS_ARB, &linked);
+    if (!linked) {
+        GLcharARB log[1024];
+        glGetInfoLogARB(program, sizeof(log), NULL, log);
+        wxLogMessage("BlurShaders::CreateProgram() : %s", log);
+
+        glDeleteObjectARB(program);
+        return false;
+    }
+
+    return true;
+}
+
+void BlurShaders::DrawQuad(float x, float y, float textureWidth, float textureHeight) {
+    GLfloat vertices[] = { 0.0f, 0.0f,  1.0f, 0.0f,  1.0f, 1.0f,  0.0f, 1.0f };
+    GLfloat texCoords[] = { x, y,
+                            x + textureWidth, y,
+                            x + textureWidth, y + textureHeight,
+                            x, y + textureHeight };
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2, GL_FLOAT, 0, vertices);
+
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glTexCoordPointer(2, GL_FLOAT, 0, texCoords);
+
+    glDrawArrays(GL_QUADS, 0, 4);
+
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        BlurShaders.h
+//
+// Author:      David Borland
+//
+// Description: Fragment programs for the two blur passes, one pair for each radius, with
+//              the taps compiled in.  Also draws the passes into a BlurTarget, either at full
+//              resolution or, for large radii, at a reduced resolution and scaled back up.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef BLURSHADERS_H
+#define BLURSHADERS_H
+
+
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "BlurTargetCache.h"
+
+
+class BlurShaders {
+public:
+    BlurShaders();
+    ~BlurShaders();
+
+    // Compiles programs for radii 1 to maxRadius.  linearSampling merges taps, and needs
+    // linear filtering on the textures being blurred.
+    bool Initialize(unsigned int maxRadius, bool linearSampling = true);
+
+    unsigned int GetMaxRadius() const;
+
+    enum Mode {
+        // Box blur at full resolution
+        Box,
+
+        // Halves the image until the radius is small, blurs there, and scales back up, so
+        // the cost stays about the same as the radius grows.  The radius is rounded up at
+        // each level, so a smoothly changing radius blurs in visible steps.
+        Pyramid
+    };
+
+    void SetMode(Mode blurMode);
+    Mode GetMode() const;
+
+    // Blurs the width x height image at (x, y) in texture into target->finalTexture, going 
+    // through target->tempTexture and any pyramid levels needed
+    void Blur(GLuint texture, BlurTarget* target, unsigned int width, unsigned int height,
+              unsigned int radius, unsigned int x = 0, unsigned int y = 0) const;
+
+private:
+    // Index 0 is radius 1
+    std::vector<GLhandleARB> horizontalPrograms;
+    std::vector<GLhandleARB> verticalPrograms;
+
+    // Plain copy, for scaling down and up the pyramid
+    GLhandleARB copyProgram;
+
+    bool linear;
+
+    Mode mode;
+
+    // Largest radius blurred without going down a level
+    static const unsigned int pyramidRadius;
+
+    // Horizontal pass from source into temp, vertical pass from temp into the buffer given,
+    // both attached to the bound fbo
+    void DoPasses(GLuint source, float x, float y, GLuint temp, GLenum tempBuffer, GLenum destinationBuffer,
+                  unsigned int width, unsigned int height, unsigned int radius) const;
+
+    static bool CreateProgram(const std::string& source, GLhandleARB& program);
+
+    // Texture coordinates go from (x, y) to (x + textureWidth, y + textureHeight)
+    static void DrawQuad(float x, float y, float textureWidth, float textureHeight);
+};
+
+
+#endif
\ No newline at end of file
@@ -0,0 +1,157 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        BlurTargetCache.cpp
+//
+// Author:      David Borland
+//
+// Description: Render targets for blurring images, shared by all images.  A target is only
+//              lent to an image while it is blurred, so the number of targets depends on how
+//              many images are blurred rather than the number of images showing.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "BlurTargetCache.h"
+
+
+// About five seconds at 60 frames per second
+const int BlurTargetCache::maxUnusedFrames = 300;
+
+
+BlurTargetCache::BlurTargetCache() {
+    frame = 0;
+}
+
+BlurTargetCache::~BlurTargetCache() {
+    for (int i = 0; i < (int)targets.size(); i++) {
+        DeleteTarget(targets[i]);
+    }
+}
+
+
+BlurTarget* BlurTargetCache::Acquire(unsigned int width, unsigned int height, Image::PixelFormat pixelFormat) {
+    GLint internalFormat = GL_RGBA;
+    if (pixelFormat == Image::LUMINANCE) internalFormat = GL_LUMINANCE;
+    else if (pixelFormat == Image::RGB || pixelFormat == Image::BGR) internalFormat = GL_RGB;
+
+    // Look for a free one
+    BlurTarget* target = NULL;
+    for (int i = 0; i < (int)targets.size(); i++) {
+        BlurTarget* t = targets[i];
+        if (!t->inUse && t->width == width && t->height == height && t->internalFormat == internalFormat) {
+            target = t;
+            break;
+        }
+    }
+
+    if (!target) {
+        target = CreateTarget(width, height, internalFormat);
+        targets.push_back(target);
+    }
+
+    target->inUse = true;
+    target->lastUsedFrame = frame;
+
+    return target;
+}
+
+void BlurTargetCache::Release(BlurTarget* target) {
+    target->inUse = false;
+    target->lastUsedFrame = frame;
+}
+
+
+void BlurTargetCache::EndFrame() {
+    frame++;
+
+    for (int i = (int)targets.size() - 1; i >= 0; i--) {
+        if (!targets[i]->inUse && frame - targets[i]->lastUsedFrame > maxUnusedFrames) {
+            DeleteTarget(targets[i]);
+            targets[i] = targets.back();
+            targets.pop_back();
+        }
+    }
+}
+
+
+int BlurTargetCache::GetNumberOfTargets() const {
+    return (int)targets.size();
+}
+
+
+BlurTarget* BlurTargetCache::CreateTarget(unsigned int width, unsigned int height, GLint internalFormat) {
+    BlurTarget* target = new BlurTarget();
+    target->width = width;
+    target->height = height;
+    target->internalFormat = internalFormat;
+    target->inUse = false;
+    target->lastUsedFrame = 0;
+
+    // Create the fbo
+    glGenFramebuffersEXT(1, &target->fbo);
+    glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, target->fbo);
+
+    // Attach the textures to the fbo
+    CreateTexture(target->tempTexture, width, height, internalFormat);
+    glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, GL_TEXTURE_RECTANGLE_ARB, target->tempTexture, 0);
+
+    CreateTexture(target->finalTexture, width, height, internalFormat);
+    glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT1_EXT, GL_TEXTURE_RECTANGLE_ARB, target->finalTexture, 0);
+
+    // Unbind the fbo
+    glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, 0);
+
+    return target;
+}
+
+void BlurTargetCache::CreateLevels(BlurTarget* target, int numLevels) {
+    while ((int)target->levels.size() < numLevels) {
+        unsigned int width = target->levels.empty() ? target->width : target->levels.back().width;
+        unsigned int height = target->levels.empty() ? target->height : target->levels.back().height;
+
+        // Round up, so every texel of the level above is covered
+        BlurLevel level;
+        level.width = (width + 1) / 2;
+        level.height = (height + 1) / 2;
+
+        glGenFramebuffersEXT(1, &level.fbo);
+        glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, level.fbo);
+
+        CreateTexture(level.texture, level.width, level.height, target->internalFormat);
+        glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, GL_TEXTURE_RECTANGLE_ARB, level.texture, 0);
+
+        CreateTexture(level.tempTexture, level.width, level.height, target->internalFormat);
+        glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT1_EXT, GL_TEXTURE_RECTANGLE_ARB, level.tempTexture, 0);
+
+        glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, 0);
+
+        target->levels.push_back(level);
+    }
+}
+
+
+void BlurTargetCache::DeleteTarget(BlurTarget* target) {
+    glDeleteFramebuffersEXT(1, &target->fbo);
+    glDeleteTextures(1, &target->tempTexture);
+    glDeleteTextures(1, &target->finalTexture);
+
+    for (int i = 0; i < (int)target->levels.size(); i++) {
+        glDeleteFramebuffersEXT(1, &target->levels[i].fbo);
+        glDeleteTextures(1, &target->levels[i].texture);
+        glDeleteTextures(1, &target->levels[i].tempTexture);
+    }
+
+    delete target;
+}
+
+void BlurTargetCache::CreateTexture(GLuint& texture, unsigned int width, unsigned int height, GLint internalFormat) {
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_RECTANGLE_ARB, texture);
+    glTexParameteri(GL_TEXTURE_RECTANGLE_ARB, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_RECTANGLE_ARB, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_RECTANGLE_ARB, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_RECTANGLE_ARB, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+
+    glTexImage2D(GL_TEXTURE_RECTANGLE_ARB, 0, internalFormat, width, height, 0, internalFormat, GL_UNSIGNED_BYTE, NULL);
+}
\ No newline at end of file
@@ -0,0 +1,89 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        BlurTargetCache.h
+//
+// Author:      David Borland
+//
+// Description: Render targets for blurring images, shared by all images.  A target is only
+//              lent to an image while it is blurred, so the number of targets depends on how
+//              many images are blurred rather than the number of images showing.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef BLURTARGETCACHE_H
+#define BLURTARGETCACHE_H
+
+
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <Image.h>
+
+
+// One step down the pyramid used by the pyramid blur
+struct BlurLevel {
+    GLuint fbo;
+
+    // The image at this size, and space for the horizontal pass
+    GLuint texture;
+    GLuint tempTexture;
+
+    unsigned int width;
+    unsigned int height;
+};
+
+
+struct BlurTarget {
+    GLuint fbo;
+
+    // Horizontal pass into the first, vertical pass into the second
+    GLuint tempTexture;
+    GLuint finalTexture;
+
+    unsigned int width;
+    unsigned int height;
+    GLint internalFormat;
+
+    // Half size, quarter size, and so on, created as needed
+    std::vector<BlurLevel> levels;
+
+    bool inUse;
+    int lastUsedFrame;
+};
+
+
+class BlurTargetCache {
+public:
+    BlurTargetCache();
+    ~BlurTargetCache();
+
+    // Lends a target of the given size and format, creating one if none is free.  Give it 
+    // back with Release() once the image no longer needs its blurred copy.
+    BlurTarget* Acquire(unsigned int width, unsigned int height, Image::PixelFormat pixelFormat);
+    void Release(BlurTarget* target);
+
+    // Call once per frame.  Deletes targets that haven't been lent for a while.
+    void EndFrame();
+
+    int GetNumberOfTargets() const;
+
+    // Makes sure the target has at least numLevels pyramid levels
+    static void CreateLevels(BlurTarget* target, int numLevels);
+
+private:
+    std::vector<BlurTarget*> targets;
+
+    int frame;
+
+    // Frames a target can go unused before it is deleted
+    static const int maxUnusedFrames;
+
+    static BlurTarget* CreateTarget(unsigned int width, unsigned int height, GLint internalFormat);
+    static void DeleteTarget(BlurTarget* target);
+    static void CreateTexture(GLuint& texture, unsigned int width, unsigned int height, GLint internalFormat);
+};
+
+
+#endif
\ No newline at end of file
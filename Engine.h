@@ -1,183 +1,250 @@
-///////////////////////////////////////////////////////////////////////////////////////////////
-//
-// Name:        Engine.h
-//
-// Author:      David Borland
-//
-// Description: Main engine of Azrael.
-//
-/////////////////////////////////////////////////////////////////////////////////////////////// 
-
-
-#ifndef ENGINE_H
-#define ENGINE_H
-
-
-#include <vector>
-#include <string>
-
-#include <wx/log.h>     // This must be included before Video.h
-
-#include <IL/il.h>
-#include <IL/ilu.h>
-
-#include <AudioStream.h>
-
-#include "AzraelImage.h"
-#include "AzraelVideo.h"
-#include "AvatarImage.h"
-#include "ViolentImage.h"
-#include "Graphics.h"
-#include "Tracking.h"
-#include "ProjectorShutter.h"
-#include "PosiTrack.h"
-#include "VideoImageConnection.h"
-
-
-struct Texture {
-    GLuint texture;
-    unsigned int width;
-    unsigned int height;
-    Image::PixelFormat pixelFormat;
-};
-
-
-class Engine {
-public:
-    Engine();
-    ~Engine();
-
-    bool Initialize(HWND win, int windowWidth, int windowHeight);
-
-    void Update();
-    void Trigger();
-    void Victimize();
-    void CoolDown1();
-    void CoolDown2();
-    bool Reset();
-    void DoViolence();
-
-    void RenderLeft() const;
-    void RenderRight() const;
-
-    enum State {
-        Normal,
-        Victimizing,
-        CoolingDown1,
-        CoolingDown2
-    };
-
-    State GetState();
-
-private:
-    // Imagery currently being shown
-    std::vector<AzraelImage*> imagery;
-    std::vector<AzraelImage*> avatars;
-    AzraelImage* violentImage;
-
-
-    // Imagery to be shown
-    std::vector<ILuint> quadrantImages;    
-    std::vector<AzraelVideo*> quadrantVideos;
-    std::vector<AzraelVideo*> timelineVideos;
-    std::vector<ILuint> avatarImages;
-    std::vector<AzraelVideo*> guardVideos;
-    std::vector<AzraelVideo*> violentVideos;
-
-
-    // Multiple copies of these might be shown at once, so store the textures instead
-    // of creating a new one each time.
-    std::vector<Texture> fragmentTextures;
-    std::vector<Texture> patchTextures;
-
-
-    // Images and videos to be play in quadrants that have not been shown
-    std::vector<ILuint> chooseQuadrantImages;
-    std::vector<AzraelVideo*> chooseQuadrantVideos;
-    std::vector<AzraelVideo*> chooseTimelineVideos;
-
-
-    // Connections between videos and images used to render them
-    std::vector<VideoImageConnection> connections;
-    VideoImageConnection* violentConnection;
-
-
-    // Sounds 
-    AudioStream* ambientSound;
-    AudioStream* victimRoomSound;
-    AudioStream* victimCenterSound;
-
-    int currentLongSound;
-    std::vector<AudioStream*> longSounds;
-
-    std::vector<std::string> fragmentSoundNames;
-    std::vector<AudioStream*> fragmentSounds;
-
-
-    // Handle rendering and tracking
-    Graphics* graphics;
-    Tracking* tracking;
-
-    ProjectorShutter* projectorShutter;
-    PosiTrack* posiTrack;
-
-
-    // Various state variables
-    int numberOfQuadrantImages;
-    int numberOfFragmentImages;
-    int numberOfOldImages;
-
-    int triggerCount;
-
-    int victimizeCount;
-
-    int activeQuadrant;
-
-    bool canLoadGuard;
-
-    State state;
-
-
-    // Load Media
-    bool LoadImages();
-    bool LoadVideos();
-    bool LoadAudio();
-
-    bool LoadImage(const std::string& fileName, ILuint& image);
-    void LoadTexture(ILuint image, Texture& texture);
-
-    void CopyChoose();
-
-
-    // Updates for different states
-    void UpdateNormal();
-    void UpdateVictimize();
-    void UpdateCoolDown1();
-    void UpdateCoolDown2();
-
-    void CheckAvatarsAndGuards();
-    void CheckQuadrant();
-    void CheckFragments();
-    void CheckFadedOut();
-
-
-    // Play Media
-    void ShowImage(ILuint imageHandle, AzraelImage*& image);
-    void ShowTexture(const Texture& texture, AzraelImage*& image);
-    void PlayVideo(AzraelVideo* video, AzraelImage*& image, bool violent = false);
-    void PlayLongAudio(int channel);
-    void PlayFragment();
-
-    void DoNewQuadrant();
-
-
-    // Utility functions
-    int GenerateQuadrant() const;
-    const Vec2 GraphicsToWalls(float position) const;
-    float WallsToGraphics(const Vec2& position) const;
-    int QuadrantToAudioChannel(int quadrant);
-    int OppositeQuadrant(int quadrant);
-};
-
-
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        Engine.h
+//
+// Author:      David Borland
+//
+// Description: Main engine of Azrael.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////// 
+
+
+#ifndef ENGINE_H
+#define ENGINE_H
+
+
+#include <vector>
+#include <string>
+
+#include <wx/log.h>     // This must be included before Video.h
+
+#include <IL/il.h>
+#include <IL/ilu.h>
+
+#include <AudioStream.h>
+
+#include "AzraelImage.h"
+#include "AzraelVideo.h"
+#include "AvatarImage.h"
+#include "ViolentImage.h"
+#include "Graphics.h"
+#include "Tracking.h"
+#include "ProjectorShutter.h"
+#include "PosiTrack.h"
+#include "VideoImageConnection.h"
+#include "TaskPool.h"
+#include "SlotMap.h"
+#include "ImagePool.h"
+#include "TextureAtlas.h"
+#include "VideoDecoder.h"
+
+
+struct Texture {
+    GLuint texture;
+    unsigned int width;
+    unsigned int height;
+    Image::PixelFormat pixelFormat;
+
+    // Corner of the image in the texture, which is shared with other images
+    unsigned int x;
+    unsigned int y;
+};
+
+
+class Engine {
+public:
+    Engine();
+    ~Engine();
+
+    bool Initialize(HWND win, int windowWidth, int windowHeight, const std::string& replayFileName = "");
+
+    // Advances everything by the given number of seconds
+    void Update(double seconds);
+    void Trigger();
+    void Victimize();
+    void CoolDown1();
+    void CoolDown2();
+    bool Reset();
+    void DoViolence();
+
+    void RenderLeft() const;
+    void RenderRight() const;
+
+    // Fraction of the way from the previous Update() to the current one to draw the images
+    void SetInterpolation(float alpha);
+
+    // Box by default, pyramid to keep large radii cheap
+    void SetBlurMode(BlurShaders::Mode mode);
+
+    enum State {
+        Normal,
+        Victimizing,
+        CoolingDown1,
+        CoolingDown2
+    };
+
+    State GetState();
+
+    bool ReplayFinished() const;
+
+private:
+    // Imagery currently being shown, drawn in the order added
+    SlotMap<AzraelImage*> imagery;
+    std::vector<AzraelImage*> avatars;
+    AzraelImage* violentImage;
+
+    // Keeps removed images for reuse
+    ImagePool imagePool;
+
+
+    // Imagery to be shown
+    std::vector<ILuint> quadrantImages;    
+    std::vector<AzraelVideo*> quadrantVideos;
+    std::vector<AzraelVideo*> timelineVideos;
+    std::vector<ILuint> avatarImages;
+    std::vector<AzraelVideo*> guardVideos;
+    std::vector<AzraelVideo*> violentVideos;
+
+
+    // Multiple copies of these might be shown at once, so store the textures instead
+    // of creating a new one each time.  They are all packed into the atlas.
+    std::vector<Texture> fragmentTextures;
+    std::vector<Texture> patchTextures;
+
+    TextureAtlas* textureAtlas;
+
+    static const unsigned int atlasPageSize;
+    static const unsigned int atlasPadding;
+
+
+    // Images and videos to be play in quadrants that have not been shown
+    std::vector<ILuint> chooseQuadrantImages;
+    std::vector<AzraelVideo*> chooseQuadrantVideos;
+    std::vector<AzraelVideo*> chooseTimelineVideos;
+
+
+    // Connections between videos and images used to render them
+    SlotMap<VideoImageConnection> connections;
+    VideoImageConnection* violentConnection;
+
+
+    // Sounds 
+    AudioStream* ambientSound;
+    AudioStream* victimRoomSound;
+    AudioStream* victimCenterSound;
+
+    int currentLongSound;
+    std::vector<AudioStream*> longSounds;
+
+    std::vector<std::string> fragmentSoundNames;
+    SlotMap<AudioStream*> fragmentSounds;
+
+
+    // Handle rendering and tracking
+    Graphics* graphics;
+    Tracking* tracking;
+
+    ProjectorShutter* projectorShutter;
+    PosiTrack* posiTrack;
+
+
+    // Reused each frame for the image distance queries
+    std::vector<Vec2> wallPositions;
+    std::vector<float> imageDistances;
+    std::vector<Vec2> viewerWallPositions;
+
+
+    // Splits the per-image loops across threads
+    TaskPool* taskPool;
+
+    // Per-thread scratch for the distance queries
+    std::vector<std::vector<float> > distanceScratch;
+
+    // Decodes the videos off the update thread
+    VideoDecoder* videoDecoder;
+
+    static const int imageUpdateGrain;
+    static const int distanceGrain;
+
+    // Milliseconds between patches while victimizing
+    static const double patchInterval;
+
+
+    // Various state variables
+    int numberOfQuadrantImages;
+    int numberOfFragmentImages;
+
+    // Images added before CoolDown2() have keys below this, and are faded out one by one
+    unsigned int oldImageKey;
+    std::vector<int> oldImages;
+
+    int triggerCount;
+
+    // Milliseconds until the next patch while victimizing
+    double victimizeTime;
+
+    int activeQuadrant;
+
+    bool canLoadGuard;
+
+    State state;
+
+
+    // Load Media
+    bool LoadImages();
+    bool LoadVideos();
+    bool LoadAudio();
+
+    bool LoadImage(const std::string& fileName, ILuint& image);
+    // Returns the index in the atlas, or -1 on error
+    int AddToAtlas(ILuint image);
+    void GetAtlasTexture(int index, Texture& texture) const;
+
+    void CopyChoose();
+
+
+    // Updates for different states
+    void UpdateNormal(double seconds);
+    void UpdateVictimize(double seconds);
+    void UpdateCoolDown1(double seconds);
+    void UpdateCoolDown2(double seconds);
+
+    // Updates the imagery and removes any that timed out
+    void UpdateImagery(double seconds);
+
+    void CheckAvatarsAndGuards();
+    void CheckQuadrant();
+    void CheckFragments();
+    void CheckFadedOut();
+
+
+    // Get images from the pool, ready for the given media
+    AzraelImage* NewImage(AzraelImage::Type type, ILuint imageHandle);
+    AzraelImage* NewImage(AzraelImage::Type type, const Texture& texture);
+    AzraelImage* NewImage(AzraelImage::Type type, AzraelVideo* video);
+
+
+    // Play Media
+    void ShowImage(ILuint imageHandle, AzraelImage*& image);
+    void ShowTexture(const Texture& texture, AzraelImage*& image);
+
+    // Returns the new connection, or an empty handle for the violent video
+    SlotMap<VideoImageConnection>::Handle PlayVideo(AzraelVideo* video, AzraelImage* image, bool violent = false);
+
+    void PlayLongAudio(int channel);
+    void PlayFragment();
+
+    void DoNewQuadrant();
+
+
+    // Utility functions
+    int GenerateQuadrant() const;
+    const Vec2 GraphicsToWalls(float position) const;
+    float WallsToGraphics(const Vec2& position) const;
+    static Image::PixelFormat VideoPixelFormat(AzraelVideo* video);
+    int QuadrantToAudioChannel(int quadrant);
+    int OppositeQuadrant(int quadrant);
+};
+
+
 #endif
\ No newline at end of file
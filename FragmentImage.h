@@ -1,29 +1,32 @@
-///////////////////////////////////////////////////////////////////////////////////////////////
-//
-// Name:        FragmentImage.h
-//
-// Author:      David Borland
-//
-// Description: Images of fragments.
-//
-/////////////////////////////////////////////////////////////////////////////////////////////// 
-
-
-#ifndef FRAGMENTIMAGE_H
-#define FRAGMENTIMAGE_H
-
-
-#include "AzraelImage.h"
-
-
-class FragmentImage : public AzraelImage {
-public:    
-    FragmentImage();
-
-    virtual void UpdateDistance(float distance);
-
-    virtual void Shift();
-};
-
-
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        FragmentImage.h
+//
+// Author:      David Borland
+//
+// Description: Images of fragments.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////// 
+
+
+#ifndef FRAGMENTIMAGE_H
+#define FRAGMENTIMAGE_H
+
+
+#include "AzraelImage.h"
+
+
+class FragmentImage : public AzraelImage {
+public:    
+    FragmentImage();
+
+    virtual Type GetType() const;
+    virtual void Reset();
+
+    virtual void UpdateDistance(float distance);
+
+    virtual void Shift();
+};
+
+
 #endif
\ No newline at end of file
@@ -0,0 +1,403 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        FrameCache.cpp
+//
+// Author:      David Borland
+//
+// Description: Reads and writes a cache of a video's frames, decoded ahead of time.  The
+//              frames are stored raw, in the same layout the video decodes to, at a fixed
+//              frame rate, followed by an index of where each frame is.  Repeated frames are
+//              stored once.  Frames are memory mapped one at a time, so they can be copied
+//              straight from the file into a texture upload.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "FrameCache.h"
+
+#include <VideoFile.h>
+
+#include <fstream>
+#include <stdio.h>
+#include <string.h>
+
+#include <wx/log.h>
+#include <wx/stopwatch.h>
+
+
+const char FrameCache::fileMagic[4] = { 'A', 'Z', 'F', 'C' };
+const int FrameCache::fileVersion = 1;
+
+// The Windows allocation granularity, so mapping a frame never needs the end of the one
+// before it
+const int FrameCache::frameAlignment = 64 * 1024;
+
+
+// Writes the data, then zeros up to the next multiple of alignment
+static bool WritePadded(FILE* file, const void* data, unsigned int size, int alignment, LONGLONG& position) {
+    if (size > 0 && fwrite(data, 1, size, file) != size) return false;
+    position += size;
+
+    unsigned int padding = (unsigned int)((alignment - position % alignment) % alignment);
+    if (padding > 0) {
+        std::vector<char> zeros(padding, 0);
+        if (fwrite(&zeros[0], 1, padding, file) != padding) return false;
+        position += padding;
+    }
+
+    return true;
+}
+
+
+FrameCache::FrameCache() {
+    file = INVALID_HANDLE_VALUE;
+    mapping = NULL;
+    size = 0;
+
+    memset(&header, 0, sizeof(Header));
+
+    view = NULL;
+    viewFrame = NULL;
+    viewOffset = 0;
+
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    allocationGranularity = info.dwAllocationGranularity;
+}
+
+FrameCache::~FrameCache() {
+    Close();
+}
+
+
+bool FrameCache::Open(const std::string& fileName) {
+    Close();
+
+    file = CreateFile(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                      OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        wxLogMessage("FrameCache::Open() : Couldn't open %s", fileName.c_str());
+        return false;
+    }
+
+    DWORD sizeHigh = 0;
+    DWORD sizeLow = GetFileSize(file, &sizeHigh);
+    size = ((LONGLONG)sizeHigh << 32) | sizeLow;
+
+    if (size < (LONGLONG)sizeof(Header)) {
+        wxLogMessage("FrameCache::Open() : %s is not a frame cache", fileName.c_str());
+        Close();
+        return false;
+    }
+
+    mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping) {
+        wxLogMessage("FrameCache::Open() : Couldn't map %s", fileName.c_str());
+        Close();
+        return false;
+    }
+
+    // Check the header
+    const unsigned char* data;
+    const unsigned char* headerView = MapView(0, sizeof(Header), data);
+    if (!headerView) {
+        wxLogMessage("FrameCache::Open() : Couldn't map %s", fileName.c_str());
+        Close();
+        return false;
+    }
+
+    memcpy(&header, data, sizeof(Header));
+    UnmapViewOfFile(headerView);
+
+    if (memcmp(header.magic, fileMagic, 4) != 0) {
+        wxLogMessage("FrameCache::Open() : %s is not a frame cache", fileName.c_str());
+        Close();
+        return false;
+    }
+
+    if (header.version != fileVersion) {
+        wxLogMessage("FrameCache::Open() : Unknown frame cache version %d in %s", header.version, fileName.c_str());
+        Close();
+        return false;
+    }
+
+    LONGLONG indexSize = (LONGLONG)header.numberOfFrames * sizeof(LONGLONG);
+    if (header.width <= 0 || header.height <= 0 || header.bytesPerPixel <= 0 ||
+        header.numberOfFrames <= 0 || header.framesPerSecond <= 0.0f ||
+        header.indexOffset < 0 || header.indexOffset + indexSize > size) {
+        wxLogMessage("FrameCache::Open() : %s is corrupt", fileName.c_str());
+        Close();
+        return false;
+    }
+
+    // Read the index
+    const unsigned char* indexView = MapView(header.indexOffset, (unsigned int)indexSize, data);
+    if (!indexView) {
+        wxLogMessage("FrameCache::Open() : Couldn't map %s", fileName.c_str());
+        Close();
+        return false;
+    }
+
+    index.resize(header.numberOfFrames);
+    memcpy(&index[0], data, (size_t)indexSize);
+    UnmapViewOfFile(indexView);
+
+    for (int i = 0; i < (int)index.size(); i++) {
+        if (index[i] < 0 || index[i] + GetFrameSize() > size) {
+            wxLogMessage("FrameCache::Open() : %s is corrupt", fileName.c_str());
+            Close();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void FrameCache::Close() {
+    UnmapFrame();
+
+    if (mapping) {
+        CloseHandle(mapping);
+        mapping = NULL;
+    }
+
+    if (file != INVALID_HANDLE_VALUE) {
+        CloseHandle(file);
+        file = INVALID_HANDLE_VALUE;
+    }
+
+    size = 0;
+
+    memset(&header, 0, sizeof(Header));
+    index.clear();
+}
+
+
+bool FrameCache::IsOpen() const {
+    return (int)index.size() > 0;
+}
+
+
+int FrameCache::GetWidth() const {
+    return header.width;
+}
+
+int FrameCache::GetHeight() const {
+    return header.height;
+}
+
+int FrameCache::GetBytesPerPixel() const {
+    return header.bytesPerPixel;
+}
+
+unsigned int FrameCache::GetFrameSize() const {
+    return header.width * header.height * header.bytesPerPixel;
+}
+
+
+int FrameCache::GetNumberOfFrames() const {
+    return header.numberOfFrames;
+}
+
+float FrameCache::GetFramesPerSecond() const {
+    return header.framesPerSecond;
+}
+
+
+double FrameCache::GetDuration() const {
+    if (header.framesPerSecond <= 0.0f) return 0.0;
+
+    return header.numberOfFrames / header.framesPerSecond;
+}
+
+
+const unsigned char* FrameCache::GetFrame(int frame) {
+    if (frame < 0 || frame >= (int)index.size()) return NULL;
+
+    // Repeated frames share their data
+    if (view && index[frame] == viewOffset) return viewFrame;
+
+    UnmapFrame();
+
+    view = MapView(index[frame], GetFrameSize(), viewFrame);
+    if (!view) {
+        wxLogMessage("FrameCache::GetFrame() : Couldn't map frame %d", frame);
+        return NULL;
+    }
+    viewOffset = index[frame];
+
+    return viewFrame;
+}
+
+
+bool FrameCache::IsRepeat(int frame) const {
+    if (frame <= 0 || frame >= (int)index.size()) return false;
+
+    return index[frame] == index[frame - 1];
+}
+
+
+bool FrameCache::Transcode(const std::string& videoFileName, const std::string& cacheFileName, float framesPerSecond) {
+    // Give up on videos that never stop
+    const double maxSeconds = 10.0 * 60.0;
+
+    VideoFile video;
+    video.SetName(videoFileName);
+    if (!video.Initialize(VideoStream::RGBA)) {
+        wxLogMessage("FrameCache::Transcode() : Couldn't open %s", videoFileName.c_str());
+        return false;
+    }
+    video.SetLoop(false);
+
+    FILE* out = fopen(cacheFileName.c_str(), "wb");
+    if (!out) {
+        wxLogMessage("FrameCache::Transcode() : Couldn't open %s", cacheFileName.c_str());
+        return false;
+    }
+
+    Header cacheHeader;
+    memcpy(cacheHeader.magic, fileMagic, 4);
+    cacheHeader.version = fileVersion;
+    cacheHeader.width = video.GetWidth();
+    cacheHeader.height = video.GetHeight();
+    cacheHeader.bytesPerPixel = video.GetVideoType() == VideoStream::RGBA ? 4 : 3;
+    cacheHeader.numberOfFrames = 0;
+    cacheHeader.framesPerSecond = framesPerSecond;
+    cacheHeader.frameAlignment = frameAlignment;
+    cacheHeader.indexOffset = 0;
+
+    unsigned int frameSize = cacheHeader.width * cacheHeader.height * cacheHeader.bytesPerPixel;
+
+    // Filled in at the end
+    LONGLONG position = 0;
+    bool ok = WritePadded(out, &cacheHeader, sizeof(Header), frameAlignment, position);
+
+    std::vector<LONGLONG> cacheIndex;
+    std::vector<unsigned char> lastFrame(frameSize);
+
+    // VideoFile decodes on its own clock, so play it through and take whatever has been
+    // decoded when each frame is due
+    video.Play();
+
+    wxStopWatch watch;
+    while (ok) {
+        video.Update();
+        if (video.IsStopped()) break;
+
+        double seconds = watch.Time() / 1000.0;
+        if (seconds > maxSeconds) {
+            wxLogMessage("FrameCache::Transcode() : %s didn't stop after %g seconds", videoFileName.c_str(), maxSeconds);
+            break;
+        }
+
+        while (ok && cacheIndex.size() < seconds * framesPerSecond) {
+            const unsigned char* buffer = video.GetBuffer();
+
+            if ((int)cacheIndex.size() > 0 && memcmp(buffer, &lastFrame[0], frameSize) == 0) {
+                // Same as the last one
+                cacheIndex.push_back(cacheIndex.back());
+            }
+            else {
+                cacheIndex.push_back(position);
+                ok = WritePadded(out, buffer, frameSize, frameAlignment, position);
+
+                memcpy(&lastFrame[0], buffer, frameSize);
+            }
+        }
+
+        Sleep(1);
+    }
+
+    video.Stop();
+
+    if (ok && (int)cacheIndex.size() == 0) {
+        wxLogMessage("FrameCache::Transcode() : No frames decoded from %s", videoFileName.c_str());
+        ok = false;
+    }
+
+    // Write the index, and the header again now that it is known where the index is
+    if (ok) {
+        cacheHeader.numberOfFrames = (int)cacheIndex.size();
+        cacheHeader.indexOffset = position;
+
+        ok = fwrite(&cacheIndex[0], sizeof(LONGLONG), cacheIndex.size(), out) == cacheIndex.size() &&
+             fseek(out, 0, SEEK_SET) == 0 &&
+             fwrite(&cacheHeader, sizeof(Header), 1, out) == 1;
+    }
+
+    if (fclose(out) != 0) ok = false;
+
+    if (!ok) {
+        wxLogMessage("FrameCache::Transcode() : Couldn't write %s", cacheFileName.c_str());
+        remove(cacheFileName.c_str());
+        return false;
+    }
+
+    wxLogMessage("FrameCache::Transcode() : Wrote %d frames of %s to %s",
+                 cacheHeader.numberOfFrames, videoFileName.c_str(), cacheFileName.c_str());
+
+    return true;
+}
+
+
+std::string FrameCache::GetFileName(const std::string& videoFileName) {
+    std::string cacheFileName = videoFileName;
+
+    std::string::size_type extension = cacheFileName.rfind('.');
+    if (extension != std::string::npos && cacheFileName.find_first_of("/\\", extension) == std::string::npos) {
+        cacheFileName.erase(extension);
+    }
+
+    return cacheFileName + ".frames";
+}
+
+
+bool FrameCache::ReadVideoNames(const std::string& videoInfoFileName, std::vector<std::string>& videoNames) {
+    std::fstream file(videoInfoFileName.c_str(), std::fstream::in);
+    if (file.fail()) {
+        wxLogMessage("FrameCache::ReadVideoNames() : Couldn't open %s", videoInfoFileName.c_str());
+        return false;
+    }
+
+    // Every other line is a flag for the video before it, and those never have an extension
+    std::string s;
+    while (!file.eof()) {
+        getline(file, s);
+
+        if (s.find('.') != std::string::npos) videoNames.push_back(s);
+    }
+
+    file.close();
+
+    return true;
+}
+
+
+const unsigned char* FrameCache::MapView(LONGLONG offset, unsigned int length, const unsigned char*& data) const {
+    // Views have to start on the allocation granularity
+    LONGLONG start = offset - offset % allocationGranularity;
+    unsigned int before = (unsigned int)(offset - start);
+
+    const unsigned char* mapped = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ,
+                                                                      (DWORD)(start >> 32), (DWORD)(start & 0xFFFFFFFF),
+                                                                      before + length);
+    if (!mapped) {
+        data = NULL;
+        return NULL;
+    }
+
+    data = mapped + before;
+
+    return mapped;
+}
+
+
+void FrameCache::UnmapFrame() {
+    if (view) {
+        UnmapViewOfFile(view);
+        view = NULL;
+    }
+
+    viewFrame = NULL;
+    viewOffset = 0;
+}
\ No newline at end of file
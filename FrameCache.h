@@ -0,0 +1,111 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        FrameCache.h
+//
+// Author:      David Borland
+//
+// Description: Reads and writes a cache of a video's frames, decoded ahead of time.  The
+//              frames are stored raw, in the same layout the video decodes to, at a fixed
+//              frame rate, followed by an index of where each frame is.  Repeated frames are
+//              stored once.  Frames are memory mapped one at a time, so they can be copied
+//              straight from the file into a texture upload.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef FRAMECACHE_H
+#define FRAMECACHE_H
+
+
+#include <string>
+#include <vector>
+
+#include <windows.h>
+
+
+class FrameCache {
+public:
+    FrameCache();
+    ~FrameCache();
+
+    bool Open(const std::string& fileName);
+    void Close();
+
+    bool IsOpen() const;
+
+    int GetWidth() const;
+    int GetHeight() const;
+    int GetBytesPerPixel() const;
+    unsigned int GetFrameSize() const;
+
+    int GetNumberOfFrames() const;
+    float GetFramesPerSecond() const;
+
+    // Length in seconds
+    double GetDuration() const;
+
+    // Maps the given frame.  Good until the next call, or Close().  Returns NULL on error.
+    const unsigned char* GetFrame(int frame);
+
+    // Whether the frame is stored once with the frame before it
+    bool IsRepeat(int frame) const;
+
+    // Plays the given video through once in real time, writing a frame to the cache every
+    // 1 / framesPerSecond seconds
+    static bool Transcode(const std::string& videoFileName, const std::string& cacheFileName,
+                          float framesPerSecond = 30.0f);
+
+    // The cache file used for a video, with the video's extension replaced
+    static std::string GetFileName(const std::string& videoFileName);
+
+    // The video file names in a video info file, e.g. Media/VideoInfo.txt
+    static bool ReadVideoNames(const std::string& videoInfoFileName, std::vector<std::string>& videoNames);
+
+    static const char fileMagic[4];
+    static const int fileVersion;
+
+private:
+    struct Header {
+        char magic[4];
+        int version;
+
+        int width;
+        int height;
+        int bytesPerPixel;
+
+        int numberOfFrames;
+        float framesPerSecond;
+
+        // Frames start on multiples of this, so each can be mapped on its own
+        int frameAlignment;
+
+        // Followed by one offset per frame
+        LONGLONG indexOffset;
+    };
+
+    // Memory mapped file
+    HANDLE file;
+    HANDLE mapping;
+    LONGLONG size;
+
+    Header header;
+    std::vector<LONGLONG> index;
+
+    // The view of the last frame asked for
+    const unsigned char* view;
+    const unsigned char* viewFrame;
+    LONGLONG viewOffset;
+
+    unsigned int allocationGranularity;
+
+    static const int frameAlignment;
+
+    // Maps length bytes at offset, returning the start of the view and a pointer to the
+    // bytes asked for
+    const unsigned char* MapView(LONGLONG offset, unsigned int length, const unsigned char*& data) const;
+
+    void UnmapFrame();
+};
+
+
+#endif
\ No newline at end of file
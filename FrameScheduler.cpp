@@ -0,0 +1,117 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        FrameScheduler.cpp
+//
+// Author:      David Borland
+//
+// Description: Paces the main loop.  The simulation runs in fixed steps of simulated time, 
+//              decoupled from rendering, which runs as fast as the display allows.  Rendering
+//              interpolates between the last two simulation states.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "FrameScheduler.h"
+
+#include <math.h>
+
+
+FrameScheduler::FrameScheduler(double stepMilliseconds, int maxStepsPerFrame) {
+    stepTime = stepMilliseconds;
+    maxSteps = maxStepsPerFrame;
+
+    LARGE_INTEGER f;
+    QueryPerformanceFrequency(&f);
+    frequency = f.QuadPart;
+
+    lastTicks = 0;
+    accumulator = 0.0;
+
+    ResetStatistics();
+}
+
+FrameScheduler::~FrameScheduler() {
+}
+
+
+void FrameScheduler::Start() {
+    LARGE_INTEGER t;
+    QueryPerformanceCounter(&t);
+    lastTicks = t.QuadPart;
+
+    accumulator = 0.0;
+
+    ResetStatistics();
+}
+
+
+int FrameScheduler::BeginFrame() {
+    LARGE_INTEGER t;
+    QueryPerformanceCounter(&t);
+
+    double frameTime = (t.QuadPart - lastTicks) * 1000.0 / frequency;
+    lastTicks = t.QuadPart;
+
+
+    // Statistics
+    numFrames++;
+    frameTimeSum += frameTime;
+    frameTimeSquaredSum += frameTime * frameTime;
+    if (frameTime > maxFrameTime) maxFrameTime = frameTime;
+
+
+    // Work out how many steps are due
+    accumulator += frameTime;
+
+    int steps = (int)(accumulator / stepTime);
+    accumulator -= steps * stepTime;
+
+    if (steps > maxSteps) {
+        droppedSteps += steps - maxSteps;
+        steps = maxSteps;
+    }
+
+    return steps;
+}
+
+
+float FrameScheduler::GetInterpolation() const {
+    return (float)(accumulator / stepTime);
+}
+
+
+int FrameScheduler::GetNumberOfFrames() const {
+    return numFrames;
+}
+
+double FrameScheduler::GetMeanFrameTime() const {
+    if (numFrames == 0) return 0.0;
+
+    return frameTimeSum / numFrames;
+}
+
+double FrameScheduler::GetFrameTimeDeviation() const {
+    if (numFrames == 0) return 0.0;
+
+    double mean = GetMeanFrameTime();
+    double variance = frameTimeSquaredSum / numFrames - mean * mean;
+
+    return variance > 0.0 ? sqrt(variance) : 0.0;
+}
+
+double FrameScheduler::GetMaxFrameTime() const {
+    return maxFrameTime;
+}
+
+int FrameScheduler::GetDroppedSteps() const {
+    return droppedSteps;
+}
+
+
+void FrameScheduler::ResetStatistics() {
+    numFrames = 0;
+    frameTimeSum = 0.0;
+    frameTimeSquaredSum = 0.0;
+    maxFrameTime = 0.0;
+    droppedSteps = 0;
+}
\ No newline at end of file
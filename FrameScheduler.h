@@ -0,0 +1,64 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        FrameScheduler.h
+//
+// Author:      David Borland
+//
+// Description: Paces the main loop.  The simulation runs in fixed steps of simulated time, 
+//              decoupled from rendering, which runs as fast as the display allows.  Rendering
+//              interpolates between the last two simulation states.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef FRAMESCHEDULER_H
+#define FRAMESCHEDULER_H
+
+
+#include <windows.h>
+
+
+class FrameScheduler {
+public:
+    FrameScheduler(double stepMilliseconds, int maxStepsPerFrame);
+    ~FrameScheduler();
+
+    void Start();
+
+    // Call at the start of each frame.  Returns the number of simulation steps to run to 
+    // catch up with the wall clock.  If more than maxStepsPerFrame are due, the rest are 
+    // dropped rather than letting a slow frame make every later frame slower.
+    int BeginFrame();
+
+    // Fraction of a step that has elapsed since the last simulation step, for interpolating
+    // between the previous and current simulation states
+    float GetInterpolation() const;
+
+    // Frame time statistics since the last reset, in milliseconds
+    int GetNumberOfFrames() const;
+    double GetMeanFrameTime() const;
+    double GetFrameTimeDeviation() const;
+    double GetMaxFrameTime() const;
+    int GetDroppedSteps() const;
+
+    void ResetStatistics();
+
+private:
+    double stepTime;
+    int maxSteps;
+
+    LONGLONG frequency;
+    LONGLONG lastTicks;
+
+    // Wall clock time not yet simulated
+    double accumulator;
+
+    int numFrames;
+    double frameTimeSum;
+    double frameTimeSquaredSum;
+    double maxFrameTime;
+    int droppedSteps;
+};
+
+
+#endif
\ No newline at end of file
@@ -1,80 +1,89 @@
-///////////////////////////////////////////////////////////////////////////////////////////////
-//
-// Name:        Graphics.h
-//
-// Author:      David Borland
-//
-// Description: Draws the graphics for Azrael.
-//
-///////////////////////////////////////////////////////////////////////////////////////////////
-
-#ifndef GRAPHICS_H
-#define GRAPHICS_H
-
-
-#include <wx/log.h>     // This must be included before Video.h
-
-#include <vector>
-
-#include "AzraelImage.h"
-#include "AvatarImage.h"
-#include "ViolentImage.h"
-
-
-class Graphics {
-public:
-    Graphics();
-    ~Graphics();
-
-    bool Initialize(int windowWidth, int windowHeight, 
-                    std::vector<AzraelImage*>* azraelImages,
-                    std::vector<AzraelImage*>* azraelAvatars,
-                    AzraelImage** violentImage);
-
-    void RenderLeft();
-    void RenderRight();
-
-    float GetViewWidth() const;
-    float GetViewHeight() const;
-
-    GLint GetFadeFragmentProgram() const;
-    GLhandleARB GetOpacityParameter() const;
-    GLhandleARB GetShiftParameter() const;
-
-    GLint GetHorizontalBlurFragmentProgram() const;
-    GLhandleARB GetHorizontalBlurParameter() const;
-
-    GLint GetVerticalBlurFragmentProgram() const;
-    GLhandleARB GetVerticalBlurParameter() const;
-
-private:
-    std::vector<AzraelImage*>* imagery;
-    std::vector<AzraelImage*>* avatars;
-    AzraelImage** violentImage;
-
-    float viewWidth;
-    float viewHeight;
-
-    GLuint backgroundLeft;
-    GLuint backgroundRight;
-
-    GLhandleARB fadeFragmentProgram;
-    GLint opacityParameter;
-    GLint shiftParameter;
-
-    GLhandleARB horizontalBlurFragmentProgram;
-    GLint horizontalBlurParameter;
-
-    GLhandleARB verticalBlurFragmentProgram;
-    GLint verticalBlurParameter;
-
-    bool InitGL();
-    void Render() const;
-    void DrawOverlays() const;
-
-    void CreateBackground();
-    void LoadTexture(GLuint& texture, const std::string& fileName);
-};
-
-
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        Graphics.h
+//
+// Author:      David Borland
+//
+// Description: Draws the graphics for Azrael.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef GRAPHICS_H
+#define GRAPHICS_H
+
+
+#include <wx/log.h>     // This must be included before Video.h
+
+#include <vector>
+
+#include "AzraelImage.h"
+#include "AvatarImage.h"
+#include "ViolentImage.h"
+#include "SlotMap.h"
+#include "BlurTargetCache.h"
+#include "BlurShaders.h"
+#include "SpriteBatch.h"
+
+
+class Graphics {
+public:
+    Graphics();
+    ~Graphics();
+
+    bool Initialize(int windowWidth, int windowHeight, 
+                    SlotMap<AzraelImage*>* azraelImages,
+                    std::vector<AzraelImage*>* azraelAvatars,
+                    AzraelImage** violentImage);
+
+    void RenderLeft();
+    void RenderRight();
+
+    // Fraction of the way from the previous update to the current one to draw the images
+    void SetInterpolation(float alpha);
+
+    void SetBlurMode(BlurShaders::Mode mode);
+
+    float GetViewWidth() const;
+    float GetViewHeight() const;
+
+    GLint GetFadeFragmentProgram() const;
+
+    const BlurShaders* GetBlurShaders() const;
+
+    // Render targets shared by all images for blurring
+    BlurTargetCache* GetBlurTargetCache() const;
+
+private:
+    SlotMap<AzraelImage*>* imagery;
+    std::vector<AzraelImage*>* avatars;
+    AzraelImage** violentImage;
+
+    float viewWidth;
+    float viewHeight;
+
+    float interpolation;
+
+    GLuint backgroundLeft;
+    GLuint backgroundRight;
+
+    GLhandleARB fadeFragmentProgram;
+
+    // Background and images for a canvas are drawn through this
+    SpriteBatch* spriteBatch;
+
+    BlurShaders* blurShaders;
+
+    BlurTargetCache* blurTargets;
+
+    bool InitGL();
+    // Draws the background and the images that fall between left and right
+    void Render(GLuint background, float left, float right) const;
+    void RenderImage(AzraelImage* image, float left, float right) const;
+    void DrawOverlays() const;
+
+    void CreateBackground();
+    void LoadTexture(GLuint& texture, const std::string& fileName);
+};
+
+
 #endif
\ No newline at end of file
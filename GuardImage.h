@@ -1,28 +1,31 @@
-///////////////////////////////////////////////////////////////////////////////////////////////
-//
-// Name:        GuardImage.h
-//
-// Author:      David Borland
-//
-// Description: Images of guards.
-//
-/////////////////////////////////////////////////////////////////////////////////////////////// 
-
-
-#ifndef GUARDIMAGE_H
-#define GUARDIMAGE_H
-
-#include "AzraelImage.h"
-
-
-class GuardImage : public AzraelImage {
-public:    
-    GuardImage();
-
-    virtual void UpdateDistance(float distance);
-
-    virtual bool DeleteOnNewQuadrant();
-};
-
-
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        GuardImage.h
+//
+// Author:      David Borland
+//
+// Description: Images of guards.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////// 
+
+
+#ifndef GUARDIMAGE_H
+#define GUARDIMAGE_H
+
+#include "AzraelImage.h"
+
+
+class GuardImage : public AzraelImage {
+public:    
+    GuardImage();
+
+    virtual Type GetType() const;
+    virtual void Reset();
+
+    virtual void UpdateDistance(float distance);
+
+    virtual bool DeleteOnNewQuadrant();
+};
+
+
 #endif
\ No newline at end of file
@@ -0,0 +1,137 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        ImagePool.cpp
+//
+// Author:      David Borland
+//
+// Description: Recycles AzraelImages, so images that come and go quickly, like fragments,
+//              aren't allocated and set up each time.  Images are pooled by type and by the
+//              resolution and pixel format of their texture.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "ImagePool.h"
+
+#include "QuadrantImage.h"
+#include "FragmentImage.h"
+#include "GuardImage.h"
+#include "PatchImage.h"
+#include "AvatarImage.h"
+#include "ViolentImage.h"
+
+
+// More than the number of fragments that can be showing at once
+const int ImagePool::maxImagesPerKey = 8;
+
+
+ImagePool::ImagePool() {
+    numberOfImages = 0;
+
+    hits = 0;
+    misses = 0;
+}
+
+ImagePool::~ImagePool() {
+    Clear();
+}
+
+
+AzraelImage* ImagePool::Acquire(AzraelImage::Type type, unsigned int width, unsigned int height, 
+                                Image::PixelFormat pixelFormat) {
+    Key key;
+    key.type = type;
+    key.width = width;
+    key.height = height;
+    key.pixelFormat = pixelFormat;
+
+    ImageMap::iterator it = images.find(key);
+    if (it != images.end() && !it->second.empty()) {
+        AzraelImage* image = it->second.back();
+        it->second.pop_back();
+        numberOfImages--;
+
+        hits++;
+
+        return image;
+    }
+
+    misses++;
+
+    return Create(type);
+}
+
+void ImagePool::Release(AzraelImage* image) {
+    if (!image) return;
+
+    // Never got a texture, so there is nothing worth keeping
+    if (!image->HasTexture()) {
+        delete image;
+        return;
+    }
+
+    Key key;
+    key.type = image->GetType();
+    key.width = image->GetTextureWidth();
+    key.height = image->GetTextureHeight();
+    key.pixelFormat = image->GetPixelFormat();
+
+    std::vector<AzraelImage*>& kept = images[key];
+    if ((int)kept.size() >= maxImagesPerKey) {
+        delete image;
+        return;
+    }
+
+    image->Reset();
+    kept.push_back(image);
+    numberOfImages++;
+}
+
+
+void ImagePool::Clear() {
+    for (ImageMap::iterator it = images.begin(); it != images.end(); it++) {
+        for (int i = 0; i < (int)it->second.size(); i++) {
+            delete it->second[i];
+        }
+    }
+    images.clear();
+
+    numberOfImages = 0;
+}
+
+
+int ImagePool::GetHits() const {
+    return hits;
+}
+
+int ImagePool::GetMisses() const {
+    return misses;
+}
+
+int ImagePool::GetNumberOfImages() const {
+    return numberOfImages;
+}
+
+
+void ImagePool::ResetCounters() {
+    hits = 0;
+    misses = 0;
+}
+
+
+AzraelImage* ImagePool::Create(AzraelImage::Type type) {
+    if (type == AzraelImage::Quadrant) return new QuadrantImage();
+    else if (type == AzraelImage::Fragment) return new FragmentImage();
+    else if (type == AzraelImage::Guard) return new GuardImage();
+    else if (type == AzraelImage::Patch) return new PatchImage();
+    else if (type == AzraelImage::Avatar) return new AvatarImage();
+    else return new ViolentImage();
+}
+
+
+bool ImagePool::Key::operator<(const Key& other) const {
+    if (type != other.type) return type < other.type;
+    if (width != other.width) return width < other.width;
+    if (height != other.height) return height < other.height;
+    return pixelFormat < other.pixelFormat;
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        ImagePool.h
+//
+// Author:      David Borland
+//
+// Description: Recycles AzraelImages, so images that come and go quickly, like fragments,
+//              aren't allocated and set up each time.  Images are pooled by type and by the
+//              resolution and pixel format of their texture.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef IMAGEPOOL_H
+#define IMAGEPOOL_H
+
+
+#include <map>
+#include <vector>
+
+#include "AzraelImage.h"
+
+
+class ImagePool {
+public:
+    ImagePool();
+    ~ImagePool();
+
+    // Returns an image of the given type whose texture was the given size and format, or a
+    // new image if there isn't one
+    AzraelImage* Acquire(AzraelImage::Type type, unsigned int width, unsigned int height, 
+                         Image::PixelFormat pixelFormat);
+
+    // Resets the image and keeps it for reuse, or deletes it if enough of its kind are kept
+    void Release(AzraelImage* image);
+
+    // Deletes all kept images
+    void Clear();
+
+    int GetHits() const;
+    int GetMisses() const;
+    int GetNumberOfImages() const;
+
+    void ResetCounters();
+
+private:
+    struct Key {
+        AzraelImage::Type type;
+        unsigned int width;
+        unsigned int height;
+        Image::PixelFormat pixelFormat;
+
+        bool operator<(const Key& other) const;
+    };
+
+    typedef std::map<Key, std::vector<AzraelImage*> > ImageMap;
+    ImageMap images;
+
+    int numberOfImages;
+
+    int hits;
+    int misses;
+
+    // Most images kept for any one key
+    static const int maxImagesPerKey;
+
+    static AzraelImage* Create(AzraelImage::Type type);
+};
+
+
+#endif
\ No newline at end of file
@@ -0,0 +1,47 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        ImageTasks.cpp
+//
+// Author:      David Borland
+//
+// Description: The per-image loops of Engine, as tasks for the TaskPool.  Neither touches 
+//              OpenGL, so they can run on any thread.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "ImageTasks.h"
+
+
+ImageUpdateTask::ImageUpdateTask(AzraelImage** imageList, double elapsedSeconds) 
+    : images(imageList), seconds(elapsedSeconds) {
+}
+
+
+void ImageUpdateTask::Run(int begin, int end, int thread) {
+    for (int i = begin; i < end; i++) {
+        images[i]->Update(seconds);
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////
+// ImageDistanceTask
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+ImageDistanceTask::ImageDistanceTask(AzraelImage** imageList, const Tracking* viewerTracking, int n,
+                                     const std::vector<Vec2>& positions, std::vector<float>& averages,
+                                     std::vector<std::vector<float> >& threadScratch)
+    : images(imageList), tracking(viewerTracking), numToAverage(n),
+      wallPositions(positions), distances(averages), scratch(threadScratch) {
+}
+
+
+void ImageDistanceTask::Run(int begin, int end, int thread) {
+    tracking->GetAverageDistances(&wallPositions[begin], end - begin, numToAverage, 
+                                  &distances[begin], scratch[thread]);
+
+    for (int i = begin; i < end; i++) {
+        images[i]->UpdateDistance(distances[i]);
+    }
+}
\ No newline at end of file
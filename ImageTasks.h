@@ -0,0 +1,58 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        ImageTasks.h
+//
+// Author:      David Borland
+//
+// Description: The per-image loops of Engine, as tasks for the TaskPool.  Neither touches 
+//              OpenGL, so they can run on any thread.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef IMAGETASKS_H
+#define IMAGETASKS_H
+
+
+#include <vector>
+
+#include "TaskPool.h"
+#include "AzraelImage.h"
+#include "Tracking.h"
+
+
+// Calls Update() on a range of images
+class ImageUpdateTask : public Task {
+public:
+    ImageUpdateTask(AzraelImage** imageList, double elapsedSeconds);
+
+    virtual void Run(int begin, int end, int thread);
+
+private:
+    AzraelImage** images;
+    double seconds;
+};
+
+
+// Average distance of the closest viewers to a range of images, passed on to the images
+// with UpdateDistance()
+class ImageDistanceTask : public Task {
+public:
+    // scratch must have an entry for each thread in the pool
+    ImageDistanceTask(AzraelImage** imageList, const Tracking* viewerTracking, int n,
+                      const std::vector<Vec2>& positions, std::vector<float>& averages,
+                      std::vector<std::vector<float> >& threadScratch);
+
+    virtual void Run(int begin, int end, int thread);
+
+private:
+    AzraelImage** images;
+    const Tracking* tracking;
+    int numToAverage;
+    const std::vector<Vec2>& wallPositions;
+    std::vector<float>& distances;
+    std::vector<std::vector<float> >& scratch;
+};
+
+
+#endif
\ No newline at end of file
@@ -1,32 +1,35 @@
-///////////////////////////////////////////////////////////////////////////////////////////////
-//
-// Name:        PatchImage.h
-//
-// Author:      David Borland
-//
-// Description: Images of patches for victim.
-//
-/////////////////////////////////////////////////////////////////////////////////////////////// 
-
-
-#ifndef PATCHIMAGE_H
-#define PATCHIMAGE_H
-
-#include "AzraelImage.h"
-
-
-class PatchImage : public AzraelImage {
-public:    
-    PatchImage();
-
-    virtual void UpdateDistance(float distance);
-
-    virtual bool Rendered();
-    virtual void SetRendered();
-
-private:
-    bool rendered;
-};
-
-
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        PatchImage.h
+//
+// Author:      David Borland
+//
+// Description: Images of patches for victim.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////// 
+
+
+#ifndef PATCHIMAGE_H
+#define PATCHIMAGE_H
+
+#include "AzraelImage.h"
+
+
+class PatchImage : public AzraelImage {
+public:    
+    PatchImage();
+
+    virtual Type GetType() const;
+    virtual void Reset();
+
+    virtual void UpdateDistance(float distance);
+
+    virtual bool Rendered();
+    virtual void SetRendered();
+
+private:
+    bool rendered;
+};
+
+
 #endif
\ No newline at end of file
@@ -0,0 +1,152 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        PixelBufferStream.cpp
+//
+// Author:      David Borland
+//
+// Description: Streams frames into a texture through a ring of pixel buffer objects.  Each
+//              frame is written into a mapped buffer and copied into the texture from there,
+//              so glTexSubImage2D() returns without waiting for the copy, and the buffer
+//              isn't written again until the copies from the other buffers have been queued.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "PixelBufferStream.h"
+
+#include <wx/log.h>
+
+#include <string.h>
+
+
+PixelBufferStream::PixelBufferStream(int numberOfBuffers) {
+    buffers.resize(numberOfBuffers, 0);
+    current = 0;
+    mapped = false;
+
+    width = height = 0;
+    pixelFormat = Image::RGBA;
+    frameSize = 0;
+}
+
+PixelBufferStream::~PixelBufferStream() {
+    DeleteBuffers();
+}
+
+
+bool PixelBufferStream::Initialize(unsigned int frameWidth, unsigned int frameHeight, Image::PixelFormat format) {
+    if (buffers[0] && frameWidth == width && frameHeight == height && format == pixelFormat) return true;
+
+    DeleteBuffers();
+
+    width = frameWidth;
+    height = frameHeight;
+    pixelFormat = format;
+    frameSize = width * height * BytesPerPixel(pixelFormat);
+
+    glGenBuffersARB((GLsizei)buffers.size(), &buffers[0]);
+    for (int i = 0; i < (int)buffers.size(); i++) {
+        if (!buffers[i]) {
+            wxLogMessage("PixelBufferStream::Initialize() : Could not create pixel buffers");
+            DeleteBuffers();
+            return false;
+        }
+
+        glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, buffers[i]);
+        glBufferDataARB(GL_PIXEL_UNPACK_BUFFER_ARB, frameSize, NULL, GL_STREAM_DRAW_ARB);
+    }
+    glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+
+    current = 0;
+
+    return true;
+}
+
+
+unsigned int PixelBufferStream::GetFrameSize() const {
+    return frameSize;
+}
+
+
+void* PixelBufferStream::Map() {
+    if (!buffers[0] || mapped) return NULL;
+
+    current = (current + 1) % (int)buffers.size();
+
+    glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, buffers[current]);
+
+    // Let the driver hand back fresh memory rather than wait, in case the copy from this
+    // buffer hasn't finished yet
+    glBufferDataARB(GL_PIXEL_UNPACK_BUFFER_ARB, frameSize, NULL, GL_STREAM_DRAW_ARB);
+    void* data = glMapBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, GL_WRITE_ONLY_ARB);
+
+    glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+
+    if (!data) {
+        wxLogMessage("PixelBufferStream::Map() : Could not map pixel buffer");
+        return NULL;
+    }
+
+    mapped = true;
+
+    return data;
+}
+
+
+void PixelBufferStream::Upload(GLuint texture) {
+    if (!mapped) return;
+
+    glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, buffers[current]);
+    glUnmapBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB);
+    mapped = false;
+
+    GLenum format = GL_RGBA;
+    if (pixelFormat == Image::LUMINANCE) format = GL_LUMINANCE;
+    else if (pixelFormat == Image::RGB) format = GL_RGB;
+    else if (pixelFormat == Image::BGR) format = GL_BGR;
+    else if (pixelFormat == Image::BGRA) format = GL_BGRA;
+
+    // With a buffer bound, the data pointer is an offset into it
+    glBindTexture(GL_TEXTURE_RECTANGLE_ARB, texture);
+
+    // BGR and luminance rows aren't always a multiple of 4 bytes
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_RECTANGLE_ARB, 0, 0, 0, width, height, format, GL_UNSIGNED_BYTE, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+}
+
+bool PixelBufferStream::Upload(GLuint texture, const void* data) {
+    void* buffer = Map();
+    if (!buffer) return false;
+
+    memcpy(buffer, data, frameSize);
+
+    Upload(texture);
+
+    return true;
+}
+
+
+int PixelBufferStream::BytesPerPixel(Image::PixelFormat pixelFormat) {
+    if (pixelFormat == Image::LUMINANCE) return 1;
+    else if (pixelFormat == Image::RGB || pixelFormat == Image::BGR) return 3;
+    else return 4;
+}
+
+
+void PixelBufferStream::DeleteBuffers() {
+    if (mapped) {
+        glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, buffers[current]);
+        glUnmapBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB);
+        glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+        mapped = false;
+    }
+
+    if (buffers[0]) glDeleteBuffersARB((GLsizei)buffers.size(), &buffers[0]);
+
+    for (int i = 0; i < (int)buffers.size(); i++) {
+        buffers[i] = 0;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        PixelBufferStream.h
+//
+// Author:      David Borland
+//
+// Description: Streams frames into a texture through a ring of pixel buffer objects.  Each
+//              frame is written into a mapped buffer and copied into the texture from there,
+//              so glTexSubImage2D() returns without waiting for the copy, and the buffer
+//              isn't written again until the copies from the other buffers have been queued.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef PIXELBUFFERSTREAM_H
+#define PIXELBUFFERSTREAM_H
+
+
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <Image.h>
+
+
+class PixelBufferStream {
+public:
+    PixelBufferStream(int numberOfBuffers = 3);
+    ~PixelBufferStream();
+
+    // Creates the buffers for frames of the given size and format, if they aren't already
+    bool Initialize(unsigned int width, unsigned int height, Image::PixelFormat pixelFormat);
+
+    unsigned int GetFrameSize() const;
+
+    // Maps the next buffer in the ring for writing one frame into.  Returns NULL on error.
+    void* Map();
+
+    // Unmaps the buffer and starts copying it into the texture
+    void Upload(GLuint texture);
+
+    // Map(), copy, and Upload()
+    bool Upload(GLuint texture, const void* data);
+
+    static int BytesPerPixel(Image::PixelFormat pixelFormat);
+
+private:
+    std::vector<GLuint> buffers;
+    int current;
+    bool mapped;
+
+    unsigned int width;
+    unsigned int height;
+    Image::PixelFormat pixelFormat;
+    unsigned int frameSize;
+
+    void DeleteBuffers();
+};
+
+
+#endif
\ No newline at end of file
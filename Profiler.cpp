@@ -0,0 +1,188 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        Profiler.cpp
+//
+// Author:      David Borland
+//
+// Description: High resolution timing of sections of the update and render loop.  Timings 
+//              are collected per frame and summarized once a second as percentiles, both in 
+//              the log window and in a dump file.  Also counts things per frame, like draw 
+//              calls, and summarizes them the same way.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "Profiler.h"
+
+#include <algorithm>
+
+#include <wx/log.h>
+
+
+bool Profiler::enabled = false;
+
+LONGLONG Profiler::frequency = 0;
+LONGLONG Profiler::startTicks = 0;
+LONGLONG Profiler::reportTicks = 0;
+
+std::vector<float> Profiler::samples[Profiler::NumberOfSections];
+
+int Profiler::frameCounts[Profiler::NumberOfCounters];
+bool Profiler::counted = false;
+std::vector<float> Profiler::counts[Profiler::NumberOfCounters];
+
+std::fstream Profiler::dump;
+
+
+static const char* sectionNames[Profiler::NumberOfSections] = {
+    "Frame",
+    "Engine::Update",
+    "Engine::UpdateNormal",
+    "Engine::UpdateVictimize",
+    "Engine::UpdateCoolDown1",
+    "Engine::UpdateCoolDown2",
+    "Graphics::RenderLeft",
+    "Graphics::RenderRight",
+    "AzraelImage::DoBlur",
+    "VideoImageConnection::Update",
+    "SwapBuffersLeft",
+    "SwapBuffersRight"
+};
+
+static const char* counterNames[Profiler::NumberOfCounters] = {
+    "DrawCalls",
+    "StateChanges",
+    "Quads"
+};
+
+
+bool Profiler::Start(const std::string& dumpFileName) {
+    LARGE_INTEGER f;
+    if (!QueryPerformanceFrequency(&f) || f.QuadPart == 0) {
+        wxLogMessage("Profiler::Start() : No high resolution timer");
+        return false;
+    }
+    frequency = f.QuadPart;
+
+    dump.open(dumpFileName.c_str(), std::fstream::out);
+    if (dump.fail()) {
+        wxLogMessage("Profiler::Start() : Couldn't open %s", dumpFileName.c_str());
+        return false;
+    }
+
+    dump << "# seconds section count p50 p95 p99 max (milliseconds, or per frame for counters)" << std::endl;
+
+    for (int i = 0; i < NumberOfSections; i++) {
+        samples[i].clear();
+        samples[i].reserve(1024);
+    }
+
+    for (int i = 0; i < NumberOfCounters; i++) {
+        frameCounts[i] = 0;
+        counts[i].clear();
+        counts[i].reserve(1024);
+    }
+    counted = false;
+
+    startTicks = reportTicks = GetTicks();
+
+    enabled = true;
+
+    return true;
+}
+
+void Profiler::Stop() {
+    if (!enabled) return;
+
+    enabled = false;
+
+    dump.close();
+}
+
+
+bool Profiler::IsEnabled() {
+    return enabled;
+}
+
+
+LONGLONG Profiler::GetTicks() {
+    LARGE_INTEGER t;
+    QueryPerformanceCounter(&t);
+
+    return t.QuadPart;
+}
+
+void Profiler::AddSample(Section section, LONGLONG ticks) {
+    samples[section].push_back((float)(ticks * 1000.0 / frequency));
+}
+
+void Profiler::AddCount(Counter counter, int count) {
+    if (!enabled) return;
+
+    frameCounts[counter] += count;
+    counted = true;
+}
+
+
+void Profiler::EndFrame() {
+    if (!enabled) return;
+
+    // Frames that didn't render, e.g. headless, don't count
+    if (counted) {
+        for (int i = 0; i < NumberOfCounters; i++) {
+            counts[i].push_back((float)frameCounts[i]);
+            frameCounts[i] = 0;
+        }
+        counted = false;
+    }
+
+    LONGLONG now = GetTicks();
+    if (now - reportTicks < frequency) return;
+
+    Report((double)(now - startTicks) / frequency);
+
+    reportTicks = now;
+}
+
+
+const char* Profiler::GetSectionName(Section section) {
+    return sectionNames[section];
+}
+
+const char* Profiler::GetCounterName(Counter counter) {
+    return counterNames[counter];
+}
+
+
+void Profiler::Report(double seconds) {
+    for (int i = 0; i < NumberOfSections; i++) {
+        Summarize(seconds, sectionNames[i], samples[i], "ms");
+    }
+
+    for (int i = 0; i < NumberOfCounters; i++) {
+        Summarize(seconds, counterNames[i], counts[i], "per frame");
+    }
+
+    dump.flush();
+}
+
+void Profiler::Summarize(double seconds, const char* name, std::vector<float>& s, const char* units) {
+    int count = (int)s.size();
+
+    if (count == 0) return;
+
+    std::sort(s.begin(), s.end());
+
+    float p50 = s[(count - 1) * 50 / 100];
+    float p95 = s[(count - 1) * 95 / 100];
+    float p99 = s[(count - 1) * 99 / 100];
+    float max = s[count - 1];
+
+    dump << seconds << " " << name << " " << count << " " 
+         << p50 << " " << p95 << " " << p99 << " " << max << "\n";
+
+    wxLogMessage("%-28s %4d  p50 %6.2f  p95 %6.2f  p99 %6.2f  max %6.2f %s", 
+                 name, count, p50, p95, p99, max, units);
+
+    s.clear();
+}
\ No newline at end of file
@@ -0,0 +1,111 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        Profiler.h
+//
+// Author:      David Borland
+//
+// Description: High resolution timing of sections of the update and render loop.  Timings 
+//              are collected per frame and summarized once a second as percentiles, both in 
+//              the log window and in a dump file.  Also counts things per frame, like draw 
+//              calls, and summarizes them the same way.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+
+#include <string>
+#include <vector>
+#include <fstream>
+
+#include <windows.h>
+
+
+class Profiler {
+public:
+    enum Section {
+        Frame,
+        EngineUpdate,
+        UpdateNormal,
+        UpdateVictimize,
+        UpdateCoolDown1,
+        UpdateCoolDown2,
+        RenderLeft,
+        RenderRight,
+        DoBlur,
+        ConnectionUpdate,
+        SwapBuffersLeft,
+        SwapBuffersRight,
+        NumberOfSections
+    };
+
+    enum Counter {
+        DrawCalls,
+        StateChanges,
+        Quads,
+        NumberOfCounters
+    };
+
+    // Starts collecting timings, writing the summaries to the given file
+    static bool Start(const std::string& dumpFileName);
+    static void Stop();
+
+    static bool IsEnabled();
+
+    static LONGLONG GetTicks();
+    static void AddSample(Section section, LONGLONG ticks);
+
+    // Adds to the counter's total for the current frame
+    static void AddCount(Counter counter, int count);
+
+    // Call once per frame.  Summarizes and clears the timings once a second.
+    static void EndFrame();
+
+    static const char* GetSectionName(Section section);
+    static const char* GetCounterName(Counter counter);
+
+private:
+    static bool enabled;
+
+    static LONGLONG frequency;
+    static LONGLONG startTicks;
+    static LONGLONG reportTicks;
+
+    // Milliseconds for each call during the current second
+    static std::vector<float> samples[NumberOfSections];
+
+    // Totals for the current frame, and for each frame during the current second
+    static int frameCounts[NumberOfCounters];
+    static bool counted;
+    static std::vector<float> counts[NumberOfCounters];
+
+    static std::fstream dump;
+
+    static void Report(double seconds);
+
+    // Sorts and clears the values
+    static void Summarize(double seconds, const char* name, std::vector<float>& values, const char* units);
+};
+
+
+// Times its own lifetime.  Costs a flag check when the profiler is off.
+class ScopedTimer {
+public:
+    ScopedTimer(Profiler::Section timerSection) {
+        section = timerSection;
+        start = Profiler::IsEnabled() ? Profiler::GetTicks() : 0;
+    }
+
+    ~ScopedTimer() {
+        if (start != 0) Profiler::AddSample(section, Profiler::GetTicks() - start);
+    }
+
+private:
+    Profiler::Section section;
+    LONGLONG start;
+};
+
+
+#endif
\ No newline at end of file
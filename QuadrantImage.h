@@ -1,27 +1,29 @@
-///////////////////////////////////////////////////////////////////////////////////////////////
-//
-// Name:        QuadrantImage.h
-//
-// Author:      David Borland
-//
-// Description: Images restricted to quadrants.
-//
-/////////////////////////////////////////////////////////////////////////////////////////////// 
-
-
-#ifndef QUADRANTIMAGE_H
-#define QUADRANTIMAGE_H
-
-
-#include "AzraelImage.h"
-
-
-class QuadrantImage : public AzraelImage {
-public:    
-    QuadrantImage();
-
-    virtual void UpdateDistance(float distance);
-};
-
-
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        QuadrantImage.h
+//
+// Author:      David Borland
+//
+// Description: Images restricted to quadrants.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////// 
+
+
+#ifndef QUADRANTIMAGE_H
+#define QUADRANTIMAGE_H
+
+
+#include "AzraelImage.h"
+
+
+class QuadrantImage : public AzraelImage {
+public:    
+    QuadrantImage();
+
+    virtual Type GetType() const;
+
+    virtual void UpdateDistance(float distance);
+};
+
+
 #endif
\ No newline at end of file
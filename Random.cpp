@@ -0,0 +1,42 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        Random.cpp
+//
+// Author:      David Borland
+//
+// Description: Seedable random number generator, used instead of rand() so that runs can be
+//              reproduced exactly, e.g. when replaying a tracker log.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "Random.h"
+
+
+const int Random::RandMax = 0xffff;
+
+unsigned int Random::seed = 1;
+unsigned int Random::state = 1;
+
+
+void Random::Seed(unsigned int value) {
+    seed = value;
+    state = value;
+}
+
+unsigned int Random::GetSeed() {
+    return seed;
+}
+
+
+int Random::Int() {
+    // 32-bit linear congruential generator.  Only use the top 16 bits, as bit n of an LCG
+    // repeats every 2^(n + 1) values, so e.g. Int() % 2 would just alternate.
+    state = state * 1664525u + 1013904223u;
+
+    return (int)(state >> 16);
+}
+
+float Random::Float() {
+    return (float)Int() / (float)RandMax;
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        Random.h
+//
+// Author:      David Borland
+//
+// Description: Seedable random number generator, used instead of rand() so that runs can be
+//              reproduced exactly, e.g. when replaying a tracker log.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef RANDOM_H
+#define RANDOM_H
+
+
+class Random {
+public:
+    static void Seed(unsigned int seed);
+    static unsigned int GetSeed();
+
+    // Returns a value in the range 0...RandMax
+    static int Int();
+
+    // Returns a value in the range 0.0...1.0
+    static float Float();
+
+    static const int RandMax;
+
+private:
+    static unsigned int seed;
+    static unsigned int state;
+};
+
+
+#endif
\ No newline at end of file
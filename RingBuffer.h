@@ -0,0 +1,92 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        RingBuffer.h
+//
+// Author:      David Borland
+//
+// Description: Lock-free single-producer/single-consumer ring buffer for passing data from
+//              a worker thread to the render thread.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+
+#include <windows.h>
+
+#include <vector>
+
+
+template <class T>
+class RingBuffer {
+public:
+    RingBuffer(int capacity = 1024);
+
+    // Only call from the producer thread.  Returns false if full.
+    bool Push(const T& value);
+
+    // Only call from the consumer thread.  Returns false if empty.
+    bool Pop(T& value);
+
+    bool Empty() const;
+    int GetCapacity() const;
+
+private:
+    std::vector<T> buffer;
+
+    // head is only written by the producer, tail only by the consumer.  The interlocked 
+    // writes make sure the data is visible before the index that publishes it.
+    volatile LONG head;
+    volatile LONG tail;
+};
+
+
+template <class T>
+RingBuffer<T>::RingBuffer(int capacity) : buffer(capacity + 1) {
+    // One slot is always left empty to tell full from empty
+    head = tail = 0;
+}
+
+
+template <class T>
+bool RingBuffer<T>::Push(const T& value) {
+    LONG h = head;
+    LONG next = (h + 1) % (LONG)buffer.size();
+
+    if (next == tail) return false;
+
+    buffer[h] = value;
+
+    InterlockedExchange(&head, next);
+
+    return true;
+}
+
+template <class T>
+bool RingBuffer<T>::Pop(T& value) {
+    LONG t = tail;
+
+    if (t == head) return false;
+
+    value = buffer[t];
+
+    InterlockedExchange(&tail, (t + 1) % (LONG)buffer.size());
+
+    return true;
+}
+
+
+template <class T>
+bool RingBuffer<T>::Empty() const {
+    return head == tail;
+}
+
+template <class T>
+int RingBuffer<T>::GetCapacity() const {
+    return (int)buffer.size() - 1;
+}
+
+
+#endif
\ No newline at end of file
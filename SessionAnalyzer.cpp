@@ -0,0 +1,341 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        SessionAnalyzer.cpp
+//
+// Author:      David Borland
+//
+// Description: Computes statistics for a directory of tracker logs by running each log 
+//              through Tracking offline.  Logs are analyzed in parallel, one log per worker
+//              thread at a time.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "SessionAnalyzer.h"
+
+#include "Tracking.h"
+#include "TrackerLogReader.h"
+
+#include <algorithm>
+#include <fstream>
+
+#include <wx/dir.h>
+#include <wx/stopwatch.h>
+
+
+const double SessionAnalyzer::occupancyInterval = 60.0;
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// SessionStatistics
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+
+SessionStatistics::SessionStatistics() {
+    valid = false;
+
+    duration = 0.0;
+
+    samples = 0;
+    resets = 0;
+
+    meanViewers = 0.0;
+    maxViewers = 0;
+
+    for (int i = 0; i < 4; i++) {
+        quadrantDwell[i] = 0.0;
+    }
+
+    fragmentTriggers = 0;
+
+    victims = 0;
+    victimMatches = 0;
+    victimDistanceSum = 0.0;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// SessionAnalyzer
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+
+SessionAnalyzer::SessionAnalyzer() {
+    nextSession = 0;
+}
+
+SessionAnalyzer::~SessionAnalyzer() {
+}
+
+
+bool SessionAnalyzer::Run(const std::string& directory) {
+    if (!wxDir::Exists(directory.c_str())) {
+        wxLogMessage("SessionAnalyzer::Run() : Couldn't find %s", directory.c_str());
+        return false;
+    }
+
+    // Text and binary logs
+    wxArrayString files;
+    wxDir::GetAllFiles(directory.c_str(), &files, "*.txt", wxDIR_FILES);
+    wxDir::GetAllFiles(directory.c_str(), &files, "*.bin", wxDIR_FILES);
+    files.Sort();
+
+    fileNames.clear();
+    for (int i = 0; i < (int)files.GetCount(); i++) {
+        std::string fileName = files[i].c_str();
+
+        // Skip our own output
+        std::string::size_type slash = fileName.find_last_of("/\\");
+        std::string name = slash == std::string::npos ? fileName : fileName.substr(slash + 1);
+        if (name == "analysis.txt" || name == "occupancy.txt") continue;
+
+        fileNames.push_back(fileName);
+    }
+
+    if ((int)fileNames.size() == 0) {
+        wxLogMessage("SessionAnalyzer::Run() : No logs in %s", directory.c_str());
+        return false;
+    }
+
+    results.clear();
+    results.resize(fileNames.size());
+    nextSession = 0;
+
+    int numThreads = wxThread::GetCPUCount();
+    if (numThreads < 1) numThreads = 1;
+    if (numThreads > (int)fileNames.size()) numThreads = (int)fileNames.size();
+
+    wxLogMessage("SessionAnalyzer::Run() : Analyzing %d logs with %d threads", (int)fileNames.size(), numThreads);
+
+    wxStopWatch watch;
+
+    // The readers log from the worker threads on failure, so keep quiet until they are done
+    wxLogNull* noLog = new wxLogNull();
+
+    std::vector<SessionAnalyzerThread*> threads;
+    for (int i = 0; i < numThreads; i++) {
+        SessionAnalyzerThread* thread = new SessionAnalyzerThread(this);
+        if (thread->Create() != wxTHREAD_NO_ERROR || thread->Run() != wxTHREAD_NO_ERROR) {
+            delete thread;
+            continue;
+        }
+
+        threads.push_back(thread);
+    }
+
+    if ((int)threads.size() == 0) {
+        // Do it all on this thread instead
+        SessionAnalyzerThread thread(this);
+        thread.Entry();
+    }
+
+    for (int i = 0; i < (int)threads.size(); i++) {
+        threads[i]->Wait();
+        delete threads[i];
+    }
+
+    delete noLog;
+
+    wxLogMessage("SessionAnalyzer::Run() : Finished in %d ms", (int)watch.Time());
+
+    // Report failures now that logging is back on
+    for (int i = 0; i < (int)results.size(); i++) {
+        if (!results[i].valid) {
+            wxLogMessage("SessionAnalyzer::Run() : Couldn't analyze %s", fileNames[i].c_str());
+        }
+    }
+
+    return WriteResults(directory);
+}
+
+
+bool SessionAnalyzer::AnalyzeSession(const std::string& fileName, SessionStatistics& statistics) {
+    statistics = SessionStatistics();
+    statistics.fileName = fileName;
+
+    TrackerLogReader reader;
+    if (!reader.Open(fileName)) return false;
+
+    int numEvents = reader.GetNumberOfEvents();
+    if (numEvents == 0) return false;
+
+    // A Tracking that is never initialized, so there is no tracker and no log.  Same room 
+    // as Tracking::Initialize().
+    Tracking tracking;
+    tracking.SetRoomExtents(Vec2(0.0, 0.0), Vec2(6.5, 6.5));
+
+    double viewerSeconds = 0.0;
+    double previousSeconds = 0.0;
+
+    for (int i = 0; i < numEvents; i++) {
+        const TrackerLogReader::Event& event = reader.GetEvent(i);
+
+        // Integrate occupancy and dwell over the time since the last event
+        double dt = event.seconds - previousSeconds;
+        if (dt > 0.0) {
+            int numViewers = tracking.GetNumberOfViewers();
+
+            viewerSeconds += numViewers * dt;
+
+            for (int q = 0; q < 4; q++) {
+                statistics.quadrantDwell[q] += tracking.GetNumberOfViewersInQuadrant(q) * dt;
+            }
+
+            // Split across occupancy intervals
+            double t = previousSeconds;
+            while (t < event.seconds) {
+                int bin = (int)(t / occupancyInterval);
+                double binEnd = std::min((bin + 1) * occupancyInterval, event.seconds);
+
+                if (bin >= (int)statistics.occupancy.size()) {
+                    statistics.occupancy.resize(bin + 1, 0.0f);
+                }
+                statistics.occupancy[bin] += (float)(numViewers * (binEnd - t));
+
+                t = binEnd;
+            }
+
+            previousSeconds = event.seconds;
+        }
+
+        // Apply the event the same way the engine would have
+        if (event.type == TrackerLogger::Sample || event.type == TrackerLogger::Remove) {
+            tracking.UpdateViewer(event.index, event.position, event.time);
+
+            if (event.type == TrackerLogger::Sample) statistics.samples++;
+
+            for (int j = 0; j < tracking.GetNumberOfViewers(); j++) {
+                if (tracking.GetViewer(j)->TriggerFragment()) statistics.fragmentTriggers++;
+            }
+
+            statistics.maxViewers = std::max(statistics.maxViewers, tracking.GetNumberOfViewers());
+        }
+        else if (event.type == TrackerLogger::Reset) {
+            tracking.Reset();
+
+            statistics.resets++;
+        }
+        else if (event.type == TrackerLogger::Victim) {
+            tracking.PickVictim();
+
+            Viewer* victim = tracking.GetVictim();
+            int victimIndex = -1;
+            for (int j = 0; j < tracking.GetNumberOfViewers(); j++) {
+                if (tracking.GetViewer(j) == victim) {
+                    victimIndex = j;
+                    break;
+                }
+            }
+
+            statistics.victims++;
+            if (victimIndex == event.index) statistics.victimMatches++;
+            if (victim) statistics.victimDistanceSum += victim->GetAverageClosestDistance();
+        }
+    }
+
+    // Nothing to time the session by, e.g. a log with only a Reset and a Victim
+    if (statistics.samples == 0) {
+        wxLogMessage("SessionAnalyzer::AnalyzeSession() : %s has no samples, skipping", fileName.c_str());
+        return false;
+    }
+
+    statistics.duration = reader.GetDuration();
+
+    if (statistics.duration > 0.0) {
+        statistics.meanViewers = viewerSeconds / statistics.duration;
+    }
+
+    // Convert the occupancy sums to means, with the last interval possibly partial
+    for (int i = 0; i < (int)statistics.occupancy.size(); i++) {
+        double length = std::min(occupancyInterval, statistics.duration - i * occupancyInterval);
+        if (length > 0.0) statistics.occupancy[i] /= (float)length;
+    }
+
+    statistics.valid = true;
+
+    return true;
+}
+
+
+bool SessionAnalyzer::WriteResults(const std::string& directory) const {
+    std::string analysisFileName = directory + "/analysis.txt";
+    std::fstream analysis(analysisFileName.c_str(), std::fstream::out);
+    if (analysis.fail()) {
+        wxLogMessage("SessionAnalyzer::WriteResults() : Couldn't open %s", analysisFileName.c_str());
+        return false;
+    }
+
+    std::string occupancyFileName = directory + "/occupancy.txt";
+    std::fstream occupancy(occupancyFileName.c_str(), std::fstream::out);
+    if (occupancy.fail()) {
+        wxLogMessage("SessionAnalyzer::WriteResults() : Couldn't open %s", occupancyFileName.c_str());
+        return false;
+    }
+
+    analysis << "# session seconds samples resets meanViewers maxViewers "
+             << "dwell0 dwell1 dwell2 dwell3 fragmentsPerMinute "
+             << "victims victimMatches meanVictimDistance" << std::endl;
+
+    occupancy << "# session meanViewers for each " << occupancyInterval << " seconds" << std::endl;
+
+    for (int i = 0; i < (int)results.size(); i++) {
+        const SessionStatistics& s = results[i];
+        if (!s.valid) continue;
+
+        std::string::size_type slash = s.fileName.find_last_of("/\\");
+        std::string name = slash == std::string::npos ? s.fileName : s.fileName.substr(slash + 1);
+
+        double minutes = s.duration / 60.0;
+
+        analysis << name << " " 
+                 << s.duration << " " 
+                 << s.samples << " " 
+                 << s.resets << " " 
+                 << s.meanViewers << " " 
+                 << s.maxViewers << " "
+                 << s.quadrantDwell[0] << " " 
+                 << s.quadrantDwell[1] << " " 
+                 << s.quadrantDwell[2] << " " 
+                 << s.quadrantDwell[3] << " "
+                 << (minutes > 0.0 ? s.fragmentTriggers / minutes : 0.0) << " "
+                 << s.victims << " " 
+                 << s.victimMatches << " " 
+                 << (s.victims > 0 ? s.victimDistanceSum / s.victims : 0.0) << std::endl;
+
+        occupancy << name;
+        for (int j = 0; j < (int)s.occupancy.size(); j++) {
+            occupancy << " " << s.occupancy[j];
+        }
+        occupancy << std::endl;
+    }
+
+    analysis.close();
+    occupancy.close();
+
+    wxLogMessage("SessionAnalyzer::WriteResults() : Wrote %s and %s", analysisFileName.c_str(), occupancyFileName.c_str());
+
+    return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// SessionAnalyzerThread
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+
+SessionAnalyzerThread::SessionAnalyzerThread(SessionAnalyzer* sessionAnalyzer) : wxThread(wxTHREAD_JOINABLE) {
+    analyzer = sessionAnalyzer;
+}
+
+
+wxThread::ExitCode SessionAnalyzerThread::Entry() {
+    int numSessions = (int)analyzer->fileNames.size();
+
+    while (true) {
+        int session = InterlockedIncrement(&analyzer->nextSession) - 1;
+        if (session >= numSessions) break;
+
+        SessionAnalyzer::AnalyzeSession(analyzer->fileNames[session], analyzer->results[session]);
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,96 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        SessionAnalyzer.h
+//
+// Author:      David Borland
+//
+// Description: Computes statistics for a directory of tracker logs by running each log 
+//              through Tracking offline.  Logs are analyzed in parallel, one log per worker
+//              thread at a time.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef SESSIONANALYZER_H
+#define SESSIONANALYZER_H
+
+
+#include <string>
+#include <vector>
+
+#include <windows.h>
+
+#include <wx/thread.h>
+
+
+struct SessionStatistics {
+    SessionStatistics();
+
+    std::string fileName;
+    bool valid;
+
+    // Seconds from the first to the last event
+    double duration;
+
+    int samples;
+    int resets;
+
+    // Number of viewers, averaged over time
+    double meanViewers;
+    int maxViewers;
+
+    // Viewer-seconds spent in each quadrant
+    double quadrantDwell[4];
+
+    // Fragment triggers from the viewer acceleration threshold
+    int fragmentTriggers;
+
+    // PickVictim() rerun at each Victim marker, compared with the victim in the log
+    int victims;
+    int victimMatches;
+    double victimDistanceSum;
+
+    // Mean number of viewers for each occupancyInterval of the session
+    std::vector<float> occupancy;
+};
+
+
+class SessionAnalyzer {
+public:
+    SessionAnalyzer();
+    ~SessionAnalyzer();
+
+    // Analyzes all logs in the directory, writing the results to analysis.txt and 
+    // occupancy.txt in the same directory
+    bool Run(const std::string& directory);
+
+    static bool AnalyzeSession(const std::string& fileName, SessionStatistics& statistics);
+
+    // Seconds per entry of SessionStatistics::occupancy
+    static const double occupancyInterval;
+
+private:
+    friend class SessionAnalyzerThread;
+
+    std::vector<std::string> fileNames;
+    std::vector<SessionStatistics> results;
+
+    // Index of the next log to be claimed by a worker
+    volatile LONG nextSession;
+
+    bool WriteResults(const std::string& directory) const;
+};
+
+
+class SessionAnalyzerThread : public wxThread {
+public:
+    SessionAnalyzerThread(SessionAnalyzer* sessionAnalyzer);
+
+    virtual ExitCode Entry();
+
+private:
+    SessionAnalyzer* analyzer;
+};
+
+
+#endif
\ No newline at end of file
@@ -0,0 +1,261 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        SlotMap.h
+//
+// Author:      David Borland
+//
+// Description: Unordered container with O(1) removal and handles that stay valid for the
+//              life of an entry.  Entries are kept packed for iteration, and each has a key
+//              giving the order to draw it in.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef SLOTMAP_H
+#define SLOTMAP_H
+
+
+#include <vector>
+#include <algorithm>
+
+
+template <class T>
+class SlotMap {
+public:
+    // Refers to one entry.  Once the entry is removed the handle is stale, and stays
+    // stale even after its slot is reused.
+    struct Handle {
+        Handle() : slot(-1), generation(0) {}
+
+        int slot;
+        unsigned int generation;
+    };
+
+    SlotMap();
+
+    // Adds a value with the next key, so it is drawn after everything already here
+    Handle Insert(const T& value);
+
+    // Returns NULL if the handle is stale
+    T* Get(const Handle& handle);
+    bool Contains(const Handle& handle) const;
+
+    // Removal moves the last entry into the gap.  When removing while iterating by index,
+    // iterate backwards, so the entry moved in has already been visited.
+    void Remove(const Handle& handle);
+    void RemoveAt(int index);
+    void Clear();
+
+    // Entries by index, in no particular order.  An index is only good until the next
+    // removal; keep a Handle to refer to an entry for longer.
+    int Size() const;
+    bool Empty() const;
+    T& operator[](int index);
+    const T& operator[](int index) const;
+    Handle GetHandle(int index) const;
+
+    // Contiguous entries for passing to loops, NULL if empty
+    T* GetData();
+
+    // Draw order.  Lower keys are drawn first.
+    unsigned int GetKey(int index) const;
+    void SetKey(int index, unsigned int key);
+
+    // The key the next Insert() will get
+    unsigned int GetNextKey() const;
+
+    // Indices of the entries sorted by key.  Sorted again only after a change.
+    const std::vector<int>& GetOrder() const;
+
+private:
+    // Entries, packed
+    std::vector<T> values;
+    std::vector<unsigned int> keys;
+    std::vector<int> valueSlots;
+
+    // Index into values of a live slot, or the next free slot of a dead one
+    struct Slot {
+        int index;
+        unsigned int generation;
+    };
+
+    std::vector<Slot> slots;
+    int freeSlots;
+
+    unsigned int nextKey;
+
+    mutable std::vector<int> order;
+    mutable bool orderChanged;
+
+    struct KeyLess {
+        KeyLess(const std::vector<unsigned int>& k) : keys(k) {}
+        bool operator()(int a, int b) const { return keys[a] < keys[b]; }
+
+        const std::vector<unsigned int>& keys;
+    };
+};
+
+
+template <class T>
+SlotMap<T>::SlotMap() {
+    freeSlots = -1;
+    nextKey = 0;
+    orderChanged = false;
+}
+
+
+template <class T>
+typename SlotMap<T>::Handle SlotMap<T>::Insert(const T& value) {
+    int slot;
+    if (freeSlots >= 0) {
+        slot = freeSlots;
+        freeSlots = slots[slot].index;
+    }
+    else {
+        slot = (int)slots.size();
+        Slot s;
+        s.generation = 0;
+        slots.push_back(s);
+    }
+
+    slots[slot].index = (int)values.size();
+
+    values.push_back(value);
+    keys.push_back(nextKey++);
+    valueSlots.push_back(slot);
+
+    orderChanged = true;
+
+    Handle handle;
+    handle.slot = slot;
+    handle.generation = slots[slot].generation;
+
+    return handle;
+}
+
+
+template <class T>
+T* SlotMap<T>::Get(const Handle& handle) {
+    if (!Contains(handle)) return NULL;
+
+    return &values[slots[handle.slot].index];
+}
+
+template <class T>
+bool SlotMap<T>::Contains(const Handle& handle) const {
+    return handle.slot >= 0 && handle.slot < (int)slots.size() &&
+           slots[handle.slot].generation == handle.generation;
+}
+
+
+template <class T>
+void SlotMap<T>::Remove(const Handle& handle) {
+    if (!Contains(handle)) return;
+
+    RemoveAt(slots[handle.slot].index);
+}
+
+template <class T>
+void SlotMap<T>::RemoveAt(int index) {
+    int slot = valueSlots[index];
+    int last = (int)values.size() - 1;
+
+    // Fill the gap with the last entry
+    if (index != last) {
+        values[index] = values[last];
+        keys[index] = keys[last];
+        valueSlots[index] = valueSlots[last];
+        slots[valueSlots[index]].index = index;
+    }
+
+    values.pop_back();
+    keys.pop_back();
+    valueSlots.pop_back();
+
+    // Retire the slot.  The new generation invalidates any handles to it.
+    slots[slot].generation++;
+    slots[slot].index = freeSlots;
+    freeSlots = slot;
+
+    orderChanged = true;
+}
+
+template <class T>
+void SlotMap<T>::Clear() {
+    for (int i = (int)values.size() - 1; i >= 0; i--) {
+        RemoveAt(i);
+    }
+}
+
+
+template <class T>
+int SlotMap<T>::Size() const {
+    return (int)values.size();
+}
+
+template <class T>
+bool SlotMap<T>::Empty() const {
+    return values.empty();
+}
+
+template <class T>
+T& SlotMap<T>::operator[](int index) {
+    return values[index];
+}
+
+template <class T>
+const T& SlotMap<T>::operator[](int index) const {
+    return values[index];
+}
+
+template <class T>
+typename SlotMap<T>::Handle SlotMap<T>::GetHandle(int index) const {
+    Handle handle;
+    handle.slot = valueSlots[index];
+    handle.generation = slots[handle.slot].generation;
+
+    return handle;
+}
+
+template <class T>
+T* SlotMap<T>::GetData() {
+    return values.empty() ? NULL : &values[0];
+}
+
+
+template <class T>
+unsigned int SlotMap<T>::GetKey(int index) const {
+    return keys[index];
+}
+
+template <class T>
+void SlotMap<T>::SetKey(int index, unsigned int key) {
+    keys[index] = key;
+
+    orderChanged = true;
+}
+
+template <class T>
+unsigned int SlotMap<T>::GetNextKey() const {
+    return nextKey;
+}
+
+
+template <class T>
+const std::vector<int>& SlotMap<T>::GetOrder() const {
+    if (orderChanged) {
+        order.resize(values.size());
+        for (int i = 0; i < (int)order.size(); i++) {
+            order[i] = i;
+        }
+
+        std::sort(order.begin(), order.end(), KeyLess(keys));
+
+        orderChanged = false;
+    }
+
+    return order;
+}
+
+
+#endif
\ No newline at end of file
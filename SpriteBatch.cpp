@@ -0,0 +1,240 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        SpriteBatch.cpp
+//
+// Author:      David Borland
+//
+// Description: Collects textured quads for a canvas and draws them from one vertex buffer
+//              with as few draw calls as possible.  Quads with the same program, texture and
+//              blending go in the same batch.  A quad can join an earlier batch if it doesn't
+//              overlap anything drawn since, so the result looks the same as drawing in order.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "SpriteBatch.h"
+
+#include <wx/log.h>
+
+#include <stddef.h>
+
+
+const int SpriteBatch::lookBack = 8;
+
+
+bool SpriteState::operator==(const SpriteState& other) const {
+    return program == other.program && target == other.target &&
+           texture == other.texture && blend == other.blend;
+}
+
+bool SpriteState::operator!=(const SpriteState& other) const {
+    return !(*this == other);
+}
+
+
+SpriteBatch::SpriteBatch() {
+    numBatches = 0;
+
+    vertexBuffer = 0;
+    vertexBufferSize = 0;
+
+    ResetCounts();
+}
+
+SpriteBatch::~SpriteBatch() {
+    if (vertexBuffer) glDeleteBuffersARB(1, &vertexBuffer);
+}
+
+
+bool SpriteBatch::Initialize() {
+    glGenBuffersARB(1, &vertexBuffer);
+    if (!vertexBuffer) {
+        wxLogMessage("SpriteBatch::Initialize() : Could not create vertex buffer");
+        return false;
+    }
+
+    return true;
+}
+
+
+void SpriteBatch::Begin() {
+    for (int i = 0; i < numBatches; i++) {
+        batches[i].vertices.clear();
+    }
+    numBatches = 0;
+}
+
+
+void SpriteBatch::Add(const SpriteState& state,
+                      float x1, float y1, float x2, float y2,
+                      float s1, float t1, float s2, float t2,
+                      float opacity, float shift) {
+    // Look for a recent batch with the same state that nothing since covers this quad
+    Batch* batch = NULL;
+    for (int i = numBatches - 1; i >= 0 && i >= numBatches - lookBack; i--) {
+        if (batches[i].state == state) {
+            batch = &batches[i];
+            break;
+        }
+
+        if (Overlaps(batches[i], x1, y1, x2, y2)) break;
+    }
+
+    if (!batch) batch = &NewBatch(state);
+
+
+    SpriteVertex v;
+    v.shift = shift;
+    v.opacity = opacity;
+
+    v.x = x1; v.y = y1; v.s = s1; v.t = t1;
+    batch->vertices.push_back(v);
+
+    v.x = x2; v.y = y1; v.s = s2; v.t = t1;
+    batch->vertices.push_back(v);
+
+    v.x = x2; v.y = y2; v.s = s2; v.t = t2;
+    batch->vertices.push_back(v);
+
+    v.x = x1; v.y = y2; v.s = s1; v.t = t2;
+    batch->vertices.push_back(v);
+
+    if (x1 < batch->xMin) batch->xMin = x1;
+    if (y1 < batch->yMin) batch->yMin = y1;
+    if (x2 > batch->xMax) batch->xMax = x2;
+    if (y2 > batch->yMax) batch->yMax = y2;
+
+    quads++;
+}
+
+
+void SpriteBatch::End() {
+    if (numBatches == 0) return;
+
+    // Copy all batches into the buffer, letting the driver give us fresh memory if the
+    // last frame's draws are still using it
+    unsigned int size = 0;
+    for (int i = 0; i < numBatches; i++) {
+        size += (unsigned int)batches[i].vertices.size() * sizeof(SpriteVertex);
+    }
+
+    glBindBufferARB(GL_ARRAY_BUFFER_ARB, vertexBuffer);
+
+    if (size > vertexBufferSize) vertexBufferSize = size;
+    glBufferDataARB(GL_ARRAY_BUFFER_ARB, vertexBufferSize, NULL, GL_STREAM_DRAW_ARB);
+
+    unsigned int offset = 0;
+    for (int i = 0; i < numBatches; i++) {
+        unsigned int batchSize = (unsigned int)batches[i].vertices.size() * sizeof(SpriteVertex);
+        glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, offset, batchSize, &batches[i].vertices[0]);
+
+        offset += batchSize;
+    }
+
+
+    // Texture coordinate 1 carries the shift and opacity
+    GLsizei stride = sizeof(SpriteVertex);
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2, GL_FLOAT, stride, (const GLvoid*)offsetof(SpriteVertex, x));
+
+    glClientActiveTextureARB(GL_TEXTURE0_ARB);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glTexCoordPointer(2, GL_FLOAT, stride, (const GLvoid*)offsetof(SpriteVertex, s));
+
+    glClientActiveTextureARB(GL_TEXTURE1_ARB);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glTexCoordPointer(2, GL_FLOAT, stride, (const GLvoid*)offsetof(SpriteVertex, shift));
+
+
+    // Draw, only changing what differs from the previous batch
+    SpriteState current = batches[0].state;
+
+    glUseProgramObjectARB(current.program);
+    glEnable(current.target);
+    glBindTexture(current.target, current.texture);
+    if (current.blend) glEnable(GL_BLEND);
+    else glDisable(GL_BLEND);
+    stateChanges += 4;
+
+    int first = 0;
+    for (int i = 0; i < numBatches; i++) {
+        const Batch& batch = batches[i];
+
+        if (batch.state.program != current.program) {
+            glUseProgramObjectARB(batch.state.program);
+            stateChanges++;
+        }
+        if (batch.state.target != current.target) {
+            glDisable(current.target);
+            glEnable(batch.state.target);
+            stateChanges++;
+        }
+        if (batch.state.texture != current.texture || batch.state.target != current.target) {
+            glBindTexture(batch.state.target, batch.state.texture);
+            stateChanges++;
+        }
+        if (batch.state.blend != current.blend) {
+            if (batch.state.blend) glEnable(GL_BLEND);
+            else glDisable(GL_BLEND);
+            stateChanges++;
+        }
+        current = batch.state;
+
+        int count = (int)batch.vertices.size();
+        glDrawArrays(GL_QUADS, first, count);
+        drawCalls++;
+
+        first += count;
+    }
+
+
+    // Restore state
+    glUseProgramObjectARB(0);
+    glDisable(current.target);
+    glDisable(GL_BLEND);
+
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glClientActiveTextureARB(GL_TEXTURE0_ARB);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+
+    glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+}
+
+
+int SpriteBatch::GetDrawCalls() const {
+    return drawCalls;
+}
+
+int SpriteBatch::GetStateChanges() const {
+    return stateChanges;
+}
+
+int SpriteBatch::GetQuads() const {
+    return quads;
+}
+
+void SpriteBatch::ResetCounts() {
+    drawCalls = 0;
+    stateChanges = 0;
+    quads = 0;
+}
+
+
+SpriteBatch::Batch& SpriteBatch::NewBatch(const SpriteState& state) {
+    if (numBatches == (int)batches.size()) batches.push_back(Batch());
+
+    Batch& batch = batches[numBatches++];
+    batch.state = state;
+    batch.vertices.clear();
+    batch.xMin = batch.yMin = 1e30f;
+    batch.xMax = batch.yMax = -1e30f;
+
+    return batch;
+}
+
+
+bool SpriteBatch::Overlaps(const Batch& batch, float x1, float y1, float x2, float y2) {
+    return x1 < batch.xMax && x2 > batch.xMin && y1 < batch.yMax && y2 > batch.yMin;
+}
\ No newline at end of file
@@ -0,0 +1,104 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        SpriteBatch.h
+//
+// Author:      David Borland
+//
+// Description: Collects textured quads for a canvas and draws them from one vertex buffer
+//              with as few draw calls as possible.  Quads with the same program, texture and
+//              blending go in the same batch.  A quad can join an earlier batch if it doesn't
+//              overlap anything drawn since, so the result looks the same as drawing in order.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef SPRITEBATCH_H
+#define SPRITEBATCH_H
+
+
+#include <vector>
+
+#include <GL/glew.h>
+
+
+// Everything that has to be the same for quads to be drawn together
+struct SpriteState {
+    // 0 for fixed function
+    GLhandleARB program;
+
+    GLenum target;
+    GLuint texture;
+
+    bool blend;
+
+    bool operator==(const SpriteState& other) const;
+    bool operator!=(const SpriteState& other) const;
+};
+
+
+// Per-vertex values the fade program reads instead of uniforms
+struct SpriteVertex {
+    float x, y;
+    float s, t;
+
+    float shift;
+    float opacity;
+};
+
+
+class SpriteBatch {
+public:
+    SpriteBatch();
+    ~SpriteBatch();
+
+    bool Initialize();
+
+    void Begin();
+
+    // Quad from (x1, y1) to (x2, y2) with texture coordinates (s1, t1) to (s2, t2)
+    void Add(const SpriteState& state,
+             float x1, float y1, float x2, float y2,
+             float s1, float t1, float s2, float t2,
+             float opacity = 1.0f, float shift = 0.0f);
+
+    // Draws everything added since Begin()
+    void End();
+
+    // Totals since the last ResetCounts()
+    int GetDrawCalls() const;
+    int GetStateChanges() const;
+    int GetQuads() const;
+
+    void ResetCounts();
+
+private:
+    struct Batch {
+        SpriteState state;
+        std::vector<SpriteVertex> vertices;
+
+        // Bounds of all quads in the batch
+        float xMin, yMin, xMax, yMax;
+    };
+
+    // Batches in drawing order.  Kept between frames so their vertex vectors keep their
+    // memory, with numBatches in use.
+    std::vector<Batch> batches;
+    int numBatches;
+
+    GLuint vertexBuffer;
+    unsigned int vertexBufferSize;
+
+    int drawCalls;
+    int stateChanges;
+    int quads;
+
+    // How many batches back to look for one with the same state
+    static const int lookBack;
+
+    Batch& NewBatch(const SpriteState& state);
+
+    static bool Overlaps(const Batch& batch, float x1, float y1, float x2, float y2);
+};
+
+
+#endif
\ No newline at end of file
@@ -0,0 +1,196 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        TaskPool.cpp
+//
+// Author:      David Borland
+//
+// Description: A fixed set of worker threads for splitting a loop into chunks and running
+//              them in parallel.  Each thread starts with an even share of the chunks and
+//              steals from the others when it runs out.  The calling thread takes part, so
+//              a pool with one thread just runs the loop.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "TaskPool.h"
+
+#include <wx/log.h>
+
+
+TaskPool::TaskPool(int numThreads) {
+    task = NULL;
+    count = 0;
+    grainSize = 1;
+    workersRunning = 0;
+    stop = false;
+
+    if (numThreads <= 0) numThreads = wxThread::GetCPUCount();
+    if (numThreads < 1) numThreads = 1;
+
+    // The calling thread is thread 0
+    for (int i = 1; i < numThreads; i++) {
+        TaskPoolThread* thread = new TaskPoolThread(this, (int)threads.size() + 1);
+        if (thread->Create() != wxTHREAD_NO_ERROR || thread->Run() != wxTHREAD_NO_ERROR) {
+            wxLogMessage("TaskPool::TaskPool() : Couldn't start worker thread");
+            delete thread;
+            break;
+        }
+
+        threads.push_back(thread);
+    }
+
+    for (int i = 0; i < (int)threads.size() + 1; i++) {
+        queues.push_back(new Queue());
+        queues.back()->begin = 0;
+        queues.back()->end = 0;
+    }
+}
+
+TaskPool::~TaskPool() {
+    stop = true;
+
+    for (int i = 0; i < (int)threads.size(); i++) {
+        start.Post();
+    }
+
+    for (int i = 0; i < (int)threads.size(); i++) {
+        threads[i]->Wait();
+        delete threads[i];
+    }
+
+    for (int i = 0; i < (int)queues.size(); i++) {
+        delete queues[i];
+    }
+}
+
+
+void TaskPool::ParallelFor(Task& loopTask, int loopCount, int loopGrainSize) {
+    if (loopCount <= 0) return;
+    if (loopGrainSize < 1) loopGrainSize = 1;
+
+    int numChunks = (loopCount + loopGrainSize - 1) / loopGrainSize;
+
+    if (numChunks == 1 || threads.empty()) {
+        loopTask.Run(0, loopCount, 0);
+        return;
+    }
+
+    task = &loopTask;
+    count = loopCount;
+    grainSize = loopGrainSize;
+
+    // Even share of the chunks for each thread.  The workers are all waiting on start,
+    // so there is no need to lock.
+    int numQueues = (int)queues.size();
+    for (int i = 0; i < numQueues; i++) {
+        queues[i]->begin = numChunks * i / numQueues;
+        queues[i]->end = numChunks * (i + 1) / numQueues;
+    }
+
+    workersRunning = (LONG)threads.size();
+    for (int i = 0; i < (int)threads.size(); i++) {
+        start.Post();
+    }
+
+    Work(0);
+
+    finished.Wait();
+
+    task = NULL;
+}
+
+
+int TaskPool::GetNumberOfThreads() const {
+    return (int)queues.size();
+}
+
+
+void TaskPool::Work(int thread) {
+    int chunk;
+    while (NextChunk(thread, chunk)) {
+        int begin = chunk * grainSize;
+        int end = begin + grainSize;
+        if (end > count) end = count;
+
+        task->Run(begin, end, thread);
+    }
+}
+
+bool TaskPool::NextChunk(int thread, int& chunk) {
+    Queue* queue = queues[thread];
+
+    for (;;) {
+        {
+            wxCriticalSectionLocker locker(queue->lock);
+
+            if (queue->begin < queue->end) {
+                chunk = queue->begin++;
+                return true;
+            }
+        }
+
+        if (!StealChunks(thread)) return false;
+    }
+}
+
+bool TaskPool::StealChunks(int thread) {
+    int numQueues = (int)queues.size();
+
+    for (int i = 1; i < numQueues; i++) {
+        Queue* victim = queues[(thread + i) % numQueues];
+
+        int begin;
+        int end;
+        {
+            wxCriticalSectionLocker locker(victim->lock);
+
+            int remaining = victim->end - victim->begin;
+            if (remaining <= 0) continue;
+
+            // Take the back half, rounding up so a single chunk can be stolen
+            int take = (remaining + 1) / 2;
+            end = victim->end;
+            begin = end - take;
+            victim->end = begin;
+        }
+
+        Queue* queue = queues[thread];
+        wxCriticalSectionLocker locker(queue->lock);
+        queue->begin = begin;
+        queue->end = end;
+
+        return true;
+    }
+
+    // Everything is taken.  Chunks still running on other threads are waited for by
+    // ParallelFor().
+    return false;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////
+// TaskPoolThread
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+TaskPoolThread::TaskPoolThread(TaskPool* taskPool, int threadIndex) : wxThread(wxTHREAD_JOINABLE) {
+    pool = taskPool;
+    index = threadIndex;
+}
+
+
+wxThread::ExitCode TaskPoolThread::Entry() {
+    for (;;) {
+        pool->start.Wait();
+
+        if (pool->stop) break;
+
+        pool->Work(index);
+
+        // Last one out lets ParallelFor() return
+        if (InterlockedDecrement(&pool->workersRunning) == 0) {
+            pool->finished.Post();
+        }
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,100 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        TaskPool.h
+//
+// Author:      David Borland
+//
+// Description: A fixed set of worker threads for splitting a loop into chunks and running
+//              them in parallel.  Each thread starts with an even share of the chunks and
+//              steals from the others when it runs out.  The calling thread takes part, so
+//              a pool with one thread just runs the loop.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef TASKPOOL_H
+#define TASKPOOL_H
+
+
+#include <vector>
+
+#include <windows.h>
+
+#include <wx/thread.h>
+
+
+// Work to be split up by TaskPool::ParallelFor()
+class Task {
+public:
+    virtual ~Task() {}
+
+    // Process items [begin, end).  thread is the index of the pool thread running the
+    // chunk, for choosing per-thread scratch space, and is 0 for the calling thread.
+    virtual void Run(int begin, int end, int thread) = 0;
+};
+
+
+class TaskPoolThread;
+
+
+class TaskPool {
+public:
+    // numThreads <= 0 uses one thread per CPU, counting the calling thread
+    TaskPool(int numThreads = 0);
+    ~TaskPool();
+
+    // Runs task over items [0, count) in chunks of grainSize items, returning when all
+    // chunks are done.  Runs on the calling thread alone if there is only one chunk.
+    // Not reentrant:  don't call from inside a Task.
+    void ParallelFor(Task& task, int count, int grainSize);
+
+    int GetNumberOfThreads() const;
+
+private:
+    friend class TaskPoolThread;
+
+    // Chunk indices [begin, end) waiting to be run.  The owning thread takes from the
+    // front, other threads steal half from the back.
+    struct Queue {
+        wxCriticalSection lock;
+        int begin;
+        int end;
+
+        // Keep queues on separate cache lines
+        char padding[64];
+    };
+
+    std::vector<Queue*> queues;
+    std::vector<TaskPoolThread*> threads;
+
+    // Current loop
+    Task* task;
+    int count;
+    int grainSize;
+
+    // Posted once per worker to start a loop, and by the last worker to finish it
+    wxSemaphore start;
+    wxSemaphore finished;
+    volatile LONG workersRunning;
+
+    bool stop;
+
+    void Work(int thread);
+    bool NextChunk(int thread, int& chunk);
+    bool StealChunks(int thread);
+};
+
+
+class TaskPoolThread : public wxThread {
+public:
+    TaskPoolThread(TaskPool* taskPool, int threadIndex);
+
+    virtual ExitCode Entry();
+
+private:
+    TaskPool* pool;
+    int index;
+};
+
+
+#endif
\ No newline at end of file
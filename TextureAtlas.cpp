@@ -0,0 +1,209 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        TextureAtlas.cpp
+//
+// Author:      David Borland
+//
+// Description: Packs many small images into a few large textures.  Images are added at load
+//              time, then Build() sorts them by height and places them left to right along
+//              shelves, starting a new shelf when a row is full and a new page when a page is
+//              full.  Each image is surrounded by copies of its edge texels, so anything that
+//              reads a little past its edges, like filtering, blurring or the fade shift,
+//              sees the same as with a texture of its own.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "TextureAtlas.h"
+
+#include <wx/log.h>
+
+#include <algorithm>
+
+
+TextureAtlas::TextureAtlas(unsigned int atlasPageSize, unsigned int atlasPadding) {
+    pageSize = atlasPageSize;
+    padding = atlasPadding;
+}
+
+TextureAtlas::~TextureAtlas() {
+    for (int i = 0; i < (int)pages.size(); i++) {
+        if (pages[i].texture) glDeleteTextures(1, &pages[i].texture);
+    }
+}
+
+
+int TextureAtlas::Add(const unsigned char* data, unsigned int width, unsigned int height, Image::PixelFormat pixelFormat) {
+    if (pixelFormat != Image::LUMINANCE && pixelFormat != Image::RGBA) {
+        wxLogMessage("TextureAtlas::Add() : Only LUMINANCE and RGBA images can be added");
+        return -1;
+    }
+
+    Entry entry;
+    entry.data.assign(data, data + width * height * Channels(pixelFormat));
+    entry.region.texture = 0;
+    entry.region.x = 0;
+    entry.region.y = 0;
+    entry.region.width = width;
+    entry.region.height = height;
+    entry.region.pixelFormat = pixelFormat;
+    entry.page = -1;
+
+    entries.push_back(entry);
+
+    return (int)entries.size() - 1;
+}
+
+
+bool TextureAtlas::Build() {
+    // Don't go past what the card can do
+    GLint maxSize = 0;
+    glGetIntegerv(GL_MAX_RECTANGLE_TEXTURE_SIZE_ARB, &maxSize);
+    if (maxSize <= 0) maxSize = pageSize;
+    if (pageSize > (unsigned int)maxSize) pageSize = maxSize;
+
+    // Tallest first, so each shelf is as tall as its first image
+    std::vector<int> order;
+    for (int i = 0; i < (int)entries.size(); i++) {
+        order.push_back(i);
+    }
+    std::stable_sort(order.begin(), order.end(), TallerFirst(entries));
+
+    for (int i = 0; i < (int)order.size(); i++) {
+        Entry& entry = entries[order[i]];
+
+        if (entry.region.width + 2 * padding > (unsigned int)maxSize ||
+            entry.region.height + 2 * padding > (unsigned int)maxSize) {
+            wxLogMessage("TextureAtlas::Build() : %u x %u image is too large", entry.region.width, entry.region.height);
+            return false;
+        }
+
+        entry.page = Place(entry);
+    }
+
+    for (int i = 0; i < (int)pages.size(); i++) {
+        Upload(i);
+    }
+
+    for (int i = 0; i < (int)entries.size(); i++) {
+        entries[i].region.texture = pages[entries[i].page].texture;
+
+        // Not needed once uploaded
+        std::vector<unsigned char>().swap(entries[i].data);
+    }
+
+    return true;
+}
+
+
+const AtlasRegion& TextureAtlas::GetRegion(int index) const {
+    return entries[index].region;
+}
+
+int TextureAtlas::GetNumberOfPages() const {
+    return (int)pages.size();
+}
+
+
+int TextureAtlas::Place(Entry& entry) {
+    unsigned int width = entry.region.width + 2 * padding;
+    unsigned int height = entry.region.height + 2 * padding;
+
+    // Only the most recent page of this format has room left
+    for (int i = (int)pages.size() - 1; i >= 0; i--) {
+        Page& page = pages[i];
+        if (page.pixelFormat != entry.region.pixelFormat) continue;
+
+        // Start a new shelf if this one is full
+        if (page.x + width > page.width) {
+            page.shelfY += page.shelfHeight;
+            page.shelfHeight = 0;
+            page.x = 0;
+        }
+
+        if (page.x + width <= page.width && page.shelfY + height <= page.height) {
+            entry.region.x = page.x + padding;
+            entry.region.y = page.shelfY + padding;
+
+            page.x += width;
+            page.shelfHeight = std::max(page.shelfHeight, height);
+            page.usedWidth = std::max(page.usedWidth, page.x);
+
+            return i;
+        }
+
+        break;
+    }
+
+    // New page, big enough for this image even if it is larger than a page
+    Page page;
+    page.texture = 0;
+    page.pixelFormat = entry.region.pixelFormat;
+    page.width = std::max(pageSize, width);
+    page.height = std::max(pageSize, height);
+    page.shelfY = 0;
+    page.shelfHeight = height;
+    page.x = width;
+    page.usedWidth = width;
+
+    pages.push_back(page);
+
+    entry.region.x = padding;
+    entry.region.y = padding;
+
+    return (int)pages.size() - 1;
+}
+
+void TextureAtlas::Upload(int index) {
+    Page& page = pages[index];
+
+    // Trim to what was used
+    page.width = page.usedWidth;
+    page.height = page.shelfY + page.shelfHeight;
+
+    int channels = Channels(page.pixelFormat);
+    std::vector<unsigned char> pixels(page.width * page.height * channels, 0);
+
+    for (int i = 0; i < (int)entries.size(); i++) {
+        const Entry& entry = entries[i];
+        if (entry.page != index) continue;
+
+        int width = (int)entry.region.width;
+        int height = (int)entry.region.height;
+        int pad = (int)padding;
+
+        // Copy with the edges repeated into the padding
+        for (int y = -pad; y < height + pad; y++) {
+            int sourceY = std::min(std::max(y, 0), height - 1);
+            unsigned char* row = &pixels[((entry.region.y + y) * page.width + entry.region.x) * channels];
+
+            for (int x = -pad; x < width + pad; x++) {
+                int sourceX = std::min(std::max(x, 0), width - 1);
+                const unsigned char* source = &entry.data[(sourceY * width + sourceX) * channels];
+
+                for (int c = 0; c < channels; c++) {
+                    row[x * channels + c] = source[c];
+                }
+            }
+        }
+    }
+
+    GLint format = page.pixelFormat == Image::LUMINANCE ? GL_LUMINANCE : GL_RGBA;
+
+    glGenTextures(1, &page.texture);
+    glBindTexture(GL_TEXTURE_RECTANGLE_ARB, page.texture);
+    glTexParameteri(GL_TEXTURE_RECTANGLE_ARB, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_RECTANGLE_ARB, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_RECTANGLE_ARB, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_RECTANGLE_ARB, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    // Luminance rows aren't always a multiple of 4 bytes
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_RECTANGLE_ARB, 0, format, page.width, page.height, 0, format, GL_UNSIGNED_BYTE, &pixels[0]);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+
+int TextureAtlas::Channels(Image::PixelFormat pixelFormat) {
+    return pixelFormat == Image::LUMINANCE ? 1 : 4;
+}
\ No newline at end of file
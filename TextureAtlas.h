@@ -0,0 +1,101 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        TextureAtlas.h
+//
+// Author:      David Borland
+//
+// Description: Packs many small images into a few large textures.  Images are added at load
+//              time, then Build() sorts them by height and places them left to right along
+//              shelves, starting a new shelf when a row is full and a new page when a page is
+//              full.  Each image is surrounded by copies of its edge texels, so anything that
+//              reads a little past its edges, like filtering, blurring or the fade shift,
+//              sees the same as with a texture of its own.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef TEXTUREATLAS_H
+#define TEXTUREATLAS_H
+
+
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <Image.h>
+
+
+// Where an image ended up
+struct AtlasRegion {
+    GLuint texture;
+
+    // Corner of the image in the texture, in texels
+    unsigned int x;
+    unsigned int y;
+
+    unsigned int width;
+    unsigned int height;
+    Image::PixelFormat pixelFormat;
+};
+
+
+class TextureAtlas {
+public:
+    // padding is the number of edge texels copied around each image
+    TextureAtlas(unsigned int pageSize = 2048, unsigned int padding = 1);
+    ~TextureAtlas();
+
+    // Copies the pixels, which must be LUMINANCE or RGBA, and returns the index to get the
+    // region with once built, or -1 on error
+    int Add(const unsigned char* data, unsigned int width, unsigned int height, Image::PixelFormat pixelFormat);
+
+    // Packs everything added and creates the textures
+    bool Build();
+
+    const AtlasRegion& GetRegion(int index) const;
+
+    int GetNumberOfPages() const;
+
+private:
+    struct Entry {
+        std::vector<unsigned char> data;
+        AtlasRegion region;
+        int page;
+    };
+
+    struct Page {
+        GLuint texture;
+        Image::PixelFormat pixelFormat;
+        unsigned int width;
+        unsigned int height;
+
+        // Current shelf
+        unsigned int shelfY;
+        unsigned int shelfHeight;
+        unsigned int x;
+
+        unsigned int usedWidth;
+    };
+
+    std::vector<Entry> entries;
+    std::vector<Page> pages;
+
+    unsigned int pageSize;
+    unsigned int padding;
+
+    // Returns the index of a page with room, adding one if needed
+    int Place(Entry& entry);
+    void Upload(int page);
+
+    static int Channels(Image::PixelFormat pixelFormat);
+
+    struct TallerFirst {
+        TallerFirst(const std::vector<Entry>& e) : entries(e) {}
+        bool operator()(int a, int b) const { return entries[a].region.height > entries[b].region.height; }
+
+        const std::vector<Entry>& entries;
+    };
+};
+
+
+#endif
\ No newline at end of file
@@ -0,0 +1,455 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        TrackerLogReader.cpp
+//
+// Author:      David Borland
+//
+// Description: Reads a tracker log, either the text format or the binary format written by 
+//              TrackerLogger.  The file is memory mapped and parsed in place, and an index
+//              of event times and Reset/Victim markers is built so that tools can seek 
+//              directly to a point in the session.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "TrackerLogReader.h"
+
+#include <algorithm>
+#include <string.h>
+
+#include <wx/log.h>
+
+
+// For searching the event index by time
+struct EventBefore {
+    bool operator()(const TrackerLogReader::Event& event, double seconds) const {
+        return event.seconds < seconds;
+    }
+};
+
+
+TrackerLogReader::TrackerLogReader() {
+    file = INVALID_HANDLE_VALUE;
+    mapping = NULL;
+    data = NULL;
+    size = 0;
+
+    binary = false;
+}
+
+TrackerLogReader::~TrackerLogReader() {
+    Close();
+}
+
+
+bool TrackerLogReader::Open(const std::string& fileName) {
+    Close();
+
+    file = CreateFile(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, 
+                      OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        wxLogMessage("TrackerLogReader::Open() : Couldn't open %s", fileName.c_str());
+        return false;
+    }
+
+    size = GetFileSize(file, NULL);
+    if (size == 0) {
+        wxLogMessage("TrackerLogReader::Open() : %s is empty", fileName.c_str());
+        Close();
+        return false;
+    }
+
+    mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping) {
+        wxLogMessage("TrackerLogReader::Open() : Couldn't map %s", fileName.c_str());
+        Close();
+        return false;
+    }
+
+    data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!data) {
+        wxLogMessage("TrackerLogReader::Open() : Couldn't map %s", fileName.c_str());
+        Close();
+        return false;
+    }
+
+    // Check for the binary header
+    binary = size >= 4 + sizeof(int) && memcmp(data, TrackerLogger::fileMagic, 4) == 0;
+
+    if (binary) {
+        int version;
+        memcpy(&version, data + 4, sizeof(int));
+        if (version != TrackerLogger::fileVersion) {
+            wxLogMessage("TrackerLogReader::Open() : Unknown binary log version %d in %s", version, fileName.c_str());
+            Close();
+            return false;
+        }
+
+        ParseBinary();
+    }
+    else {
+        ParseText();
+    }
+
+    SetTimes();
+
+    return true;
+}
+
+void TrackerLogReader::Close() {
+    if (data) {
+        UnmapViewOfFile(data);
+        data = NULL;
+    }
+
+    if (mapping) {
+        CloseHandle(mapping);
+        mapping = NULL;
+    }
+
+    if (file != INVALID_HANDLE_VALUE) {
+        CloseHandle(file);
+        file = INVALID_HANDLE_VALUE;
+    }
+
+    size = 0;
+    binary = false;
+
+    events.clear();
+    resets.clear();
+    victims.clear();
+}
+
+
+bool TrackerLogReader::IsBinary() const {
+    return binary;
+}
+
+
+int TrackerLogReader::GetNumberOfEvents() const {
+    return (int)events.size();
+}
+
+const TrackerLogReader::Event& TrackerLogReader::GetEvent(int event) const {
+    return events[event];
+}
+
+
+double TrackerLogReader::GetDuration() const {
+    if ((int)events.size() == 0) return 0.0;
+
+    return events.back().seconds;
+}
+
+
+int TrackerLogReader::Seek(double seconds) const {
+    return (int)(std::lower_bound(events.begin(), events.end(), seconds, EventBefore()) - events.begin());
+}
+
+int TrackerLogReader::Seek(const timeval& time) const {
+    if ((int)events.size() == 0) return 0;
+
+    return Seek(0.001 * vrpn_TimevalMsecs(vrpn_TimevalDiff(time, events[0].time)));
+}
+
+
+int TrackerLogReader::FindNext(TrackerLogger::RecordType type, int fromEvent) const {
+    const std::vector<int>* markers = GetMarkers(type);
+    if (!markers) return -1;
+
+    std::vector<int>::const_iterator it = std::lower_bound(markers->begin(), markers->end(), fromEvent);
+    if (it == markers->end()) return -1;
+
+    return *it;
+}
+
+
+int TrackerLogReader::GetNumberOfMarkers(TrackerLogger::RecordType type) const {
+    const std::vector<int>* markers = GetMarkers(type);
+    if (!markers) return 0;
+
+    return (int)markers->size();
+}
+
+int TrackerLogReader::GetMarker(TrackerLogger::RecordType type, int marker) const {
+    return (*GetMarkers(type))[marker];
+}
+
+
+void TrackerLogReader::ParseBinary() {
+    const int headerSize = 4 + sizeof(int);
+    int numRecords = (size - headerSize) / sizeof(TrackerLogger::Record);
+
+    events.reserve(numRecords);
+
+    const char* p = data + headerSize;
+    for (int i = 0; i < numRecords; i++, p += sizeof(TrackerLogger::Record)) {
+        // The mapped records aren't guaranteed to be aligned
+        TrackerLogger::Record record;
+        memcpy(&record, p, sizeof(TrackerLogger::Record));
+
+        Event event;
+        event.type = (TrackerLogger::RecordType)record.type;
+        event.index = record.index;
+        event.position = event.type == TrackerLogger::Remove ? 
+                         Vec3(-10.0, -10.0, -10.0) : 
+                         Vec3(record.x, record.y, record.z);
+        event.time.tv_sec = record.sec;
+        event.time.tv_usec = record.usec;
+
+        AddEvent(event);
+    }
+}
+
+void TrackerLogReader::ParseText() {
+    // Rough guess at the number of lines, to avoid regrowing
+    events.reserve(size / 32);
+
+    const char* p = data;
+    const char* end = data + size;
+    while (p < end) {
+        const char* lineEnd = (const char*)memchr(p, '\n', end - p);
+        if (!lineEnd) lineEnd = end;
+
+        Event event;
+        if (ParseLine(p, lineEnd, event)) {
+            AddEvent(event);
+        }
+
+        p = lineEnd + 1;
+    }
+}
+
+
+bool TrackerLogReader::ParseLine(const char* begin, const char* end, Event& event) const {
+    // Some older logs start with the date and time without a line break, e.g.
+    // "2008-03-2615:44:221 2.09091 ...", so skip over it
+    const int headerLength = 18;
+    if (end - begin > headerLength && begin[4] == '-' && begin[7] == '-' && begin[12] == ':') {
+        begin += headerLength;
+    }
+
+    const char* tokenEnd;
+    const char* token = NextToken(begin, end, tokenEnd);
+    if (token == tokenEnd) return false;
+
+    const char* secEnd;
+    const char* secToken;
+    const char* usecEnd;
+    const char* usecToken;
+    long sec, usec;
+
+    if (TokenEquals(token, tokenEnd, "Reset")) {
+        // "Reset sec usec", or just "Reset" in some older logs.  The time is replaced by
+        // SetTimes() anyway.
+        event.type = TrackerLogger::Reset;
+        event.index = -1;
+        event.position = Vec3(0.0, 0.0, 0.0);
+        event.time.tv_sec = event.time.tv_usec = 0;
+
+        return true;
+    }
+
+    if (TokenEquals(token, tokenEnd, "Victim")) {
+        // "Victim index"
+        const char* indexEnd;
+        const char* index = NextToken(tokenEnd, end, indexEnd);
+
+        long i;
+        if (!ParseInt(index, indexEnd, i)) return false;
+
+        event.type = TrackerLogger::Victim;
+        event.index = (int)i;
+        event.position = Vec3(0.0, 0.0, 0.0);
+        event.time.tv_sec = event.time.tv_usec = 0;
+
+        return true;
+    }
+
+    long index;
+    if (!ParseInt(token, tokenEnd, index)) return false;
+
+    const char* secondEnd;
+    const char* second = NextToken(tokenEnd, end, secondEnd);
+    const char* p = secondEnd;
+
+    if (TokenEquals(second, secondEnd, "Remove")) {
+        // "index Remove sec usec", so send the removal position
+        event.type = TrackerLogger::Remove;
+        event.position = Vec3(-10.0, -10.0, -10.0);
+    }
+    else {
+        // "index x y z sec usec"
+        const char* yEnd;
+        const char* y = NextToken(p, end, yEnd);
+        const char* zEnd;
+        const char* z = NextToken(yEnd, end, zEnd);
+        p = zEnd;
+
+        double vx, vy, vz;
+        if (!ParseFloat(second, secondEnd, vx) || 
+            !ParseFloat(y, yEnd, vy) || 
+            !ParseFloat(z, zEnd, vz)) return false;
+
+        event.type = TrackerLogger::Sample;
+        event.position = Vec3(vx, vy, vz);
+    }
+
+    secToken = NextToken(p, end, secEnd);
+    usecToken = NextToken(secEnd, end, usecEnd);
+    if (!ParseInt(secToken, secEnd, sec) || !ParseInt(usecToken, usecEnd, usec)) return false;
+
+    event.index = (int)index;
+    event.time.tv_sec = sec;
+    event.time.tv_usec = usec;
+
+    return true;
+}
+
+
+void TrackerLogReader::AddEvent(const Event& event) {
+    if (event.type == TrackerLogger::Reset) {
+        resets.push_back((int)events.size());
+    }
+    else if (event.type == TrackerLogger::Victim) {
+        victims.push_back((int)events.size());
+    }
+
+    events.push_back(event);
+}
+
+
+void TrackerLogReader::SetTimes() {
+    // Only samples and removals are on the tracker's clock
+    int first = 0;
+    while (first < (int)events.size() && 
+           (events[first].type == TrackerLogger::Reset || events[first].type == TrackerLogger::Victim)) {
+        first++;
+    }
+
+    timeval startTime;
+    startTime.tv_sec = startTime.tv_usec = 0;
+    if (first < (int)events.size()) startTime = events[first].time;
+
+    timeval time = startTime;
+    double seconds = 0.0;
+    for (int i = 0; i < (int)events.size(); i++) {
+        Event& event = events[i];
+
+        if (event.type == TrackerLogger::Reset || event.type == TrackerLogger::Victim) {
+            event.time = time;
+            event.seconds = seconds;
+        }
+        else {
+            event.seconds = 0.001 * vrpn_TimevalMsecs(vrpn_TimevalDiff(event.time, startTime));
+            if (event.seconds < seconds) event.seconds = seconds;
+
+            time = event.time;
+            seconds = event.seconds;
+        }
+    }
+}
+
+
+const std::vector<int>* TrackerLogReader::GetMarkers(TrackerLogger::RecordType type) const {
+    if (type == TrackerLogger::Reset) return &resets;
+    if (type == TrackerLogger::Victim) return &victims;
+
+    return NULL;
+}
+
+
+const char* TrackerLogReader::SkipSpace(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+
+    return p;
+}
+
+const char* TrackerLogReader::NextToken(const char* p, const char* end, const char*& tokenEnd) {
+    p = SkipSpace(p, end);
+
+    tokenEnd = p;
+    while (tokenEnd < end && *tokenEnd != ' ' && *tokenEnd != '\t' && *tokenEnd != '\r') tokenEnd++;
+
+    return p;
+}
+
+bool TrackerLogReader::TokenEquals(const char* begin, const char* end, const char* s) {
+    int length = (int)strlen(s);
+
+    return end - begin == length && strncmp(begin, s, length) == 0;
+}
+
+bool TrackerLogReader::ParseInt(const char* begin, const char* end, long& value) {
+    if (begin == end) return false;
+
+    bool negative = false;
+    if (*begin == '-' || *begin == '+') {
+        negative = *begin == '-';
+        begin++;
+    }
+
+    if (begin == end) return false;
+
+    value = 0;
+    for (const char* p = begin; p < end; p++) {
+        if (*p < '0' || *p > '9') return false;
+        value = value * 10 + (*p - '0');
+    }
+
+    if (negative) value = -value;
+
+    return true;
+}
+
+bool TrackerLogReader::ParseFloat(const char* begin, const char* end, double& value) {
+    if (begin == end) return false;
+
+    const char* p = begin;
+
+    bool negative = false;
+    if (*p == '-' || *p == '+') {
+        negative = *p == '-';
+        p++;
+    }
+
+    // Integer and fractional parts
+    double v = 0.0;
+    int digits = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        v = v * 10.0 + (*p - '0');
+        p++;
+        digits++;
+    }
+
+    if (p < end && *p == '.') {
+        p++;
+
+        double scale = 0.1;
+        while (p < end && *p >= '0' && *p <= '9') {
+            v += (*p - '0') * scale;
+            scale *= 0.1;
+            p++;
+            digits++;
+        }
+    }
+
+    if (digits == 0) return false;
+
+    // Exponent, e.g. "1.5e-005" as written by the stream operators
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        long exponent;
+        if (!ParseInt(p + 1, end, exponent)) return false;
+
+        for (; exponent > 0; exponent--) v *= 10.0;
+        for (; exponent < 0; exponent++) v *= 0.1;
+
+        p = end;
+    }
+
+    if (p != end) return false;
+
+    value = negative ? -v : v;
+
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,110 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        TrackerLogReader.h
+//
+// Author:      David Borland
+//
+// Description: Reads a tracker log, either the text format or the binary format written by 
+//              TrackerLogger.  The file is memory mapped and parsed in place, and an index
+//              of event times and Reset/Victim markers is built so that tools can seek 
+//              directly to a point in the session.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef TRACKERLOGREADER_H
+#define TRACKERLOGREADER_H
+
+
+#include <string>
+#include <vector>
+
+#include <windows.h>
+
+#include <Vec3.h>
+
+#include <vrpn_Shared.h>
+
+#include "TrackerLogger.h"
+
+
+class TrackerLogReader {
+public:
+    TrackerLogReader();
+    ~TrackerLogReader();
+
+    bool Open(const std::string& fileName);
+    void Close();
+
+    bool IsBinary() const;
+
+    struct Event {
+        TrackerLogger::RecordType type;
+        int index;
+        Vec3 position;
+
+        // Samples carry the tracker's clock, but Reset events are stamped with the wall 
+        // clock, and Victim events not at all.  So Reset and Victim events get the time of
+        // the preceding sample, or the following one at the start of the log.
+        timeval time;
+
+        // Seconds since the first sample.  Samples from different sensors can arrive 
+        // slightly out of order, so this is clamped to never decrease, which keeps the 
+        // index sorted.
+        double seconds;
+    };
+
+    int GetNumberOfEvents() const;
+    const Event& GetEvent(int event) const;
+
+    // Session length in seconds
+    double GetDuration() const;
+
+    // Returns the first event at or after the given number of seconds since the first 
+    // event, or the number of events if there is none
+    int Seek(double seconds) const;
+    int Seek(const timeval& time) const;
+
+    // Returns the first event of the given type at or after the given event, or -1 if 
+    // there is none.  Only Reset and Victim events are indexed.
+    int FindNext(TrackerLogger::RecordType type, int fromEvent = 0) const;
+
+    int GetNumberOfMarkers(TrackerLogger::RecordType type) const;
+    int GetMarker(TrackerLogger::RecordType type, int marker) const;
+
+private:
+    // Memory mapped file
+    HANDLE file;
+    HANDLE mapping;
+    const char* data;
+    unsigned int size;
+
+    bool binary;
+
+    std::vector<Event> events;
+
+    std::vector<int> resets;
+    std::vector<int> victims;
+
+    void ParseBinary();
+    void ParseText();
+
+    bool ParseLine(const char* begin, const char* end, Event& event) const;
+
+    void AddEvent(const Event& event);
+
+    // Sets the event times and seconds once all events are parsed
+    void SetTimes();
+
+    const std::vector<int>* GetMarkers(TrackerLogger::RecordType type) const;
+
+    // Tokenizer working directly on the mapped file
+    static const char* SkipSpace(const char* p, const char* end);
+    static const char* NextToken(const char* p, const char* end, const char*& tokenEnd);
+    static bool TokenEquals(const char* begin, const char* end, const char* s);
+    static bool ParseInt(const char* begin, const char* end, long& value);
+    static bool ParseFloat(const char* begin, const char* end, double& value);
+};
+
+
+#endif
\ No newline at end of file
@@ -0,0 +1,254 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        TrackerLogger.cpp
+//
+// Author:      David Borland
+//
+// Description: Writes the tracker log as compact binary records.  Records are buffered in
+//              memory and written to disk by a background thread, so logging a sample never
+//              waits on the file system.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "TrackerLogger.h"
+
+#include <fstream>
+#include <string.h>
+#include <io.h>
+
+#include <wx/log.h>
+
+
+const char TrackerLogger::fileMagic[4] = { 'A', 'Z', 'T', 'L' };
+const int TrackerLogger::fileVersion = 1;
+
+const int TrackerLoggerThread::flushInterval = 250;
+const int TrackerLoggerThread::syncInterval = 5000;
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// TrackerLogger
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+
+TrackerLogger::TrackerLogger() {
+    file = NULL;
+    thread = NULL;
+}
+
+TrackerLogger::~TrackerLogger() {
+    Close();
+}
+
+
+bool TrackerLogger::Open(const std::string& fileName) {
+    Close();
+
+    file = fopen(fileName.c_str(), "wb");
+    if (!file) {
+        wxLogMessage("TrackerLogger::Open() : Couldn't open %s", fileName.c_str());
+        return false;
+    }
+
+    // Write the header
+    fwrite(fileMagic, sizeof(char), 4, file);
+    fwrite(&fileVersion, sizeof(int), 1, file);
+
+    // Large enough for several seconds of a full room, so the buffers don't grow in practice
+    frontBuffer.reserve(16384);
+    backBuffer.reserve(16384);
+
+    // Start writing
+    thread = new TrackerLoggerThread(this);
+    if (thread->Create() != wxTHREAD_NO_ERROR || thread->Run() != wxTHREAD_NO_ERROR) {
+        wxLogMessage("TrackerLogger::Open() : Couldn't start logging thread");
+        delete thread;
+        thread = NULL;
+
+        fclose(file);
+        file = NULL;
+
+        return false;
+    }
+
+    return true;
+}
+
+void TrackerLogger::Close() {
+    if (thread) {
+        thread->Stop();
+        thread->Wait();
+        delete thread;
+        thread = NULL;
+    }
+
+    if (file) {
+        // Write anything left over
+        Flush(true);
+
+        fclose(file);
+        file = NULL;
+    }
+}
+
+
+bool TrackerLogger::IsOpen() const {
+    return file != NULL;
+}
+
+
+void TrackerLogger::LogSample(int index, const Vec3& position, const timeval& time) {
+    Record record;
+    record.type = Sample;
+    record.index = index;
+    record.x = position.X();
+    record.y = position.Y();
+    record.z = position.Z();
+    record.sec = (int)time.tv_sec;
+    record.usec = (int)time.tv_usec;
+
+    AddRecord(record);
+}
+
+void TrackerLogger::LogRemove(int index, const timeval& time) {
+    Record record;
+    memset(&record, 0, sizeof(Record));
+    record.type = Remove;
+    record.index = index;
+    record.sec = (int)time.tv_sec;
+    record.usec = (int)time.tv_usec;
+
+    AddRecord(record);
+}
+
+void TrackerLogger::LogReset(const timeval& time) {
+    Record record;
+    memset(&record, 0, sizeof(Record));
+    record.type = Reset;
+    record.sec = (int)time.tv_sec;
+    record.usec = (int)time.tv_usec;
+
+    AddRecord(record);
+}
+
+void TrackerLogger::LogVictim(int index) {
+    Record record;
+    memset(&record, 0, sizeof(Record));
+    record.type = Victim;
+    record.index = index;
+
+    AddRecord(record);
+}
+
+
+bool TrackerLogger::ConvertToText(const std::string& binaryFileName, const std::string& textFileName) {
+    FILE* in = fopen(binaryFileName.c_str(), "rb");
+    if (!in) {
+        wxLogMessage("TrackerLogger::ConvertToText() : Couldn't open %s", binaryFileName.c_str());
+        return false;
+    }
+
+    // Check the header
+    char magic[4];
+    int version;
+    if (fread(magic, sizeof(char), 4, in) != 4 || memcmp(magic, fileMagic, 4) != 0 ||
+        fread(&version, sizeof(int), 1, in) != 1 || version != fileVersion) {
+        wxLogMessage("TrackerLogger::ConvertToText() : %s is not a binary tracker log", binaryFileName.c_str());
+        fclose(in);
+        return false;
+    }
+
+    std::fstream out(textFileName.c_str(), std::fstream::out);
+    if (out.fail()) {
+        wxLogMessage("TrackerLogger::ConvertToText() : Couldn't open %s", textFileName.c_str());
+        fclose(in);
+        return false;
+    }
+
+    // Same layout Tracking used to write directly
+    Record record;
+    while (fread(&record, sizeof(Record), 1, in) == 1) {
+        if (record.type == Sample) {
+            out << record.index << " " << 
+                   record.x << " " << record.y << " " << record.z << " " <<
+                   record.sec << " " << record.usec << "\n"; 
+        }
+        else if (record.type == Remove) {
+            out << record.index << " Remove " << record.sec << " " << record.usec << "\n"; 
+        }
+        else if (record.type == Reset) {
+            out << "Reset " << record.sec << " " << record.usec << "\n";
+        }
+        else if (record.type == Victim) {
+            out << "Victim " << record.index << "\n";
+        }
+    }
+
+    fclose(in);
+    out.close();
+
+    return true;
+}
+
+
+void TrackerLogger::AddRecord(const Record& record) {
+    if (!file) return;
+
+    wxCriticalSectionLocker lock(bufferLock);
+    frontBuffer.push_back(record);
+}
+
+
+void TrackerLogger::Flush(bool sync) {
+    // Grab what has been logged so far
+    bufferLock.Enter();
+    frontBuffer.swap(backBuffer);
+    bufferLock.Leave();
+
+    if ((int)backBuffer.size() > 0) {
+        fwrite(&backBuffer[0], sizeof(Record), backBuffer.size(), file);
+        backBuffer.clear();
+
+        fflush(file);
+    }
+
+    if (sync) {
+        // Make sure it actually hits the disk
+        _commit(_fileno(file));
+    }
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// TrackerLoggerThread
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+
+TrackerLoggerThread::TrackerLoggerThread(TrackerLogger* trackerLogger) : wxThread(wxTHREAD_JOINABLE) {
+    logger = trackerLogger;
+
+    stop = false;
+}
+
+
+wxThread::ExitCode TrackerLoggerThread::Entry() {
+    int sinceSync = 0;
+
+    while (!stop && !TestDestroy()) {
+        Sleep(flushInterval);
+
+        sinceSync += flushInterval;
+        bool sync = sinceSync >= syncInterval;
+        if (sync) sinceSync = 0;
+
+        logger->Flush(sync);
+    }
+
+    return 0;
+}
+
+
+void TrackerLoggerThread::Stop() {
+    stop = true;
+}
\ No newline at end of file
@@ -0,0 +1,111 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        TrackerLogger.h
+//
+// Author:      David Borland
+//
+// Description: Writes the tracker log as compact binary records.  Records are buffered in
+//              memory and written to disk by a background thread, so logging a sample never
+//              waits on the file system.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef TRACKERLOGGER_H
+#define TRACKERLOGGER_H
+
+
+#include <string>
+#include <vector>
+#include <stdio.h>
+
+#include <wx/thread.h>
+
+#include <Vec3.h>
+
+#include <vrpn_Shared.h>
+
+
+// Forward declarations
+class TrackerLoggerThread;
+
+
+class TrackerLogger {
+public:
+    TrackerLogger();
+    ~TrackerLogger();
+
+    bool Open(const std::string& fileName);
+    void Close();
+
+    bool IsOpen() const;
+
+    void LogSample(int index, const Vec3& position, const timeval& time);
+    void LogRemove(int index, const timeval& time);
+    void LogReset(const timeval& time);
+    void LogVictim(int index);
+
+    // Converts a binary log to the original text layout, e.g. "index x y z sec usec"
+    static bool ConvertToText(const std::string& binaryFileName, const std::string& textFileName);
+
+    // On-disk layout
+    enum RecordType {
+        Sample,
+        Remove,
+        Reset,
+        Victim
+    };
+
+    struct Record {
+        int type;
+        int index;
+        float x;
+        float y;
+        float z;
+        int sec;
+        int usec;
+    };
+
+    static const char fileMagic[4];
+    static const int fileVersion;
+
+private:
+    friend class TrackerLoggerThread;
+
+    FILE* file;
+
+    // Records are added to frontBuffer, and the thread swaps it with backBuffer to write
+    std::vector<Record> frontBuffer;
+    std::vector<Record> backBuffer;
+    wxCriticalSection bufferLock;
+
+    TrackerLoggerThread* thread;
+
+    void AddRecord(const Record& record);
+
+    // Called from the thread.  Writes whatever has been logged so far, and optionally 
+    // commits it to disk.
+    void Flush(bool sync);
+};
+
+
+class TrackerLoggerThread : public wxThread {
+public:
+    TrackerLoggerThread(TrackerLogger* trackerLogger);
+
+    virtual ExitCode Entry();
+
+    void Stop();
+
+private:
+    TrackerLogger* logger;
+
+    volatile bool stop;
+
+    // Milliseconds between writes and between commits to disk
+    static const int flushInterval;
+    static const int syncInterval;
+};
+
+
+#endif
\ No newline at end of file
@@ -0,0 +1,108 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        TrackerReplay.cpp
+//
+// Author:      David Borland
+//
+// Description: Replays a tracker log written by Tracking, feeding the recorded samples to 
+//              Tracking::UpdateViewer in place of the live vrpn tracker.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "TrackerReplay.h"
+
+#include "Tracking.h"
+#include "TrackerLogReader.h"
+
+#include <wx/log.h>
+
+
+TrackerReplay::TrackerReplay() {
+    currentSample = 0;
+    replayTime = 0.0;
+    currentTime.tv_sec = currentTime.tv_usec = 0;
+}
+
+TrackerReplay::~TrackerReplay() {
+}
+
+
+bool TrackerReplay::Initialize(const std::string& fileName) {
+    TrackerLogReader reader;
+    if (!reader.Open(fileName)) {
+        wxLogMessage("TrackerReplay::Initialize() : Couldn't read %s", fileName.c_str());
+        return false;
+    }
+
+    samples.clear();
+    samples.reserve(reader.GetNumberOfEvents());
+
+    // "Reset" and "Victim" events are generated by the engine itself, so only replay samples
+    for (int i = 0; i < reader.GetNumberOfEvents(); i++) {
+        const TrackerLogReader::Event& event = reader.GetEvent(i);
+
+        if (event.type == TrackerLogger::Sample || event.type == TrackerLogger::Remove) {
+            Sample sample;
+            sample.index = event.index;
+            sample.position = event.position;
+            sample.time = event.time;
+
+            samples.push_back(sample);
+        }
+    }
+
+    if ((int)samples.size() == 0) {
+        wxLogMessage("TrackerReplay::Initialize() : No samples in %s", fileName.c_str());
+        return false;
+    }
+
+    wxLogMessage("TrackerReplay::Initialize() : %d samples", (int)samples.size());
+
+    Rewind();
+
+    return true;
+}
+
+
+void TrackerReplay::Update(Tracking* tracking, double seconds) {
+    if (Finished()) return;
+
+    replayTime += seconds;
+
+    // Send all samples up to the current replay time
+    const timeval& startTime = samples[0].time;
+    while (currentSample < (int)samples.size()) {
+        const Sample& sample = samples[currentSample];
+
+        double sampleTime = 0.001 * vrpn_TimevalMsecs(vrpn_TimevalDiff(sample.time, startTime));
+        if (sampleTime > replayTime) break;
+
+        tracking->UpdateViewer(sample.index, sample.position, sample.time);
+        currentTime = sample.time;
+
+        currentSample++;
+    }
+}
+
+
+void TrackerReplay::Rewind() {
+    currentSample = 0;
+    replayTime = 0.0;
+
+    if ((int)samples.size() > 0) currentTime = samples[0].time;
+}
+
+bool TrackerReplay::Finished() const {
+    return currentSample >= (int)samples.size();
+}
+
+
+const timeval& TrackerReplay::GetCurrentTime() const {
+    return currentTime;
+}
+
+
+int TrackerReplay::GetNumberOfSamples() const {
+    return (int)samples.size();
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        TrackerReplay.h
+//
+// Author:      David Borland
+//
+// Description: Replays a tracker log written by Tracking, feeding the recorded samples to 
+//              Tracking::UpdateViewer in place of the live vrpn tracker.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef TRACKERREPLAY_H
+#define TRACKERREPLAY_H
+
+
+#include <string>
+#include <vector>
+
+#include <Vec3.h>
+
+#include <vrpn_Shared.h>
+
+
+// Forward declarations
+class Tracking;
+
+
+class TrackerReplay {
+public:
+    TrackerReplay();
+    ~TrackerReplay();
+
+    bool Initialize(const std::string& fileName);
+
+    // Advances the replay clock by the given number of seconds, passing all samples recorded 
+    // up to that point on to tracking.  The clock is not tied to the wall clock, so the same
+    // sequence of calls always produces the same sequence of samples.
+    void Update(Tracking* tracking, double seconds);
+
+    void Rewind();
+    bool Finished() const;
+
+    const timeval& GetCurrentTime() const;
+
+    int GetNumberOfSamples() const;
+
+private:
+    struct Sample {
+        int index;
+        Vec3 position;
+        timeval time;
+    };
+
+    std::vector<Sample> samples;
+    int currentSample;
+
+    double replayTime;
+    timeval currentTime;
+};
+
+
+#endif
\ No newline at end of file
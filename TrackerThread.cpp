@@ -0,0 +1,37 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        TrackerThread.cpp
+//
+// Author:      David Borland
+//
+// Description: Runs the vrpn tracker connection on its own thread, so network processing 
+//              doesn't happen in the render timer.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "TrackerThread.h"
+
+
+TrackerThread::TrackerThread(vrpn_Tracker_Remote* vrpnTracker) : wxThread(wxTHREAD_JOINABLE) {
+    tracker = vrpnTracker;
+
+    stop = false;
+}
+
+
+wxThread::ExitCode TrackerThread::Entry() {
+    while (!stop && !TestDestroy()) {
+        // Callbacks registered on the tracker are called from here
+        tracker->mainloop();
+
+        vrpn_SleepMsecs(1);
+    }
+
+    return 0;
+}
+
+
+void TrackerThread::Stop() {
+    stop = true;
+}
\ No newline at end of file
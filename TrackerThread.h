@@ -0,0 +1,38 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        TrackerThread.h
+//
+// Author:      David Borland
+//
+// Description: Runs the vrpn tracker connection on its own thread, so network processing 
+//              doesn't happen in the render timer.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef TRACKERTHREAD_H
+#define TRACKERTHREAD_H
+
+
+#include <wx/thread.h>
+
+#include <vrpn_Tracker.h>
+
+
+class TrackerThread : public wxThread {
+public:
+    TrackerThread(vrpn_Tracker_Remote* vrpnTracker);
+
+    virtual ExitCode Entry();
+
+    // Ask the thread to finish.  Call Wait() afterwards.
+    void Stop();
+
+private:
+    vrpn_Tracker_Remote* tracker;
+
+    volatile bool stop;
+};
+
+
+#endif
\ No newline at end of file
@@ -1,274 +1,547 @@
-///////////////////////////////////////////////////////////////////////////////////////////////
-//
-// Name:        Tracking.cpp
-//
-// Author:      David Borland
-//
-// Description: Main Tracking of Azrael.
-//
-/////////////////////////////////////////////////////////////////////////////////////////////// 
-
-
-#include "Tracking.h"
-
-#include <algorithm>
-
-#include <wx/datetime.h>
-
-
-Tracking::Tracking() {
-    gotWorkspace = false;
-}
-
-Tracking::~Tracking() {
-    delete tracker;
-
-    trackerLog.close();
-}
-
-
-bool Tracking::Initialize(std::vector<AzraelImage*>* avatarImages) {
-    // Initialize VRPN
-    tracker = new vrpn_Tracker_Remote("UbiSense@localhost");
-    tracker->register_change_handler(this, &Tracking::HandleTracker);
-
-// This should be how it's done, but it sometimes hangs...
-/*
-    tracker->register_change_handler(this, &Tracking::HandleWorkspace);
-
-    // Get the workspace from the tracker
-    tracker->request_workspace();
-    for (int i = 0; i < 5000; i++) {
-        tracker->mainloop();
-
-        vrpn_SleepMsecs(1);
-
-        if (gotWorkspace) break;
-    }
-    if (!gotWorkspace) {
-        wxLogMessage("Tracking::Initialize() : Could not get workspace from tracker");
-        return false;
-    }   
-*/
-    // ...so just hard code it...
-    SetRoomExtents(Vec2(0.0, 0.0), Vec2(6.5, 6.5));
-
-
-    // Open the tracker log
-    wxDateTime now = wxDateTime::Now();
-    std::string fileName = "Logs/";
-    fileName += now.FormatISODate().c_str();
-    fileName += "_";
-    fileName += now.FormatISOTime().c_str();
-    fileName += ".txt";
-
-    for (int i = 0; i < (int)fileName.size(); i++) {
-        if (fileName[i] == ':') fileName[i] = '-';
-    }
-    trackerLog.open(fileName.c_str(), std::fstream::out);
-
-    // Copy the avatarImages pointer
-    avatars = avatarImages;
-
-    return true;
-}
-
-
-void Tracking::Update() {
-    tracker->mainloop();    
-}
-
-
-void Tracking::Reset() {
-    for (int i = 0; i < (int)viewers.size(); i++) {
-        viewers[i]->Reset();
-    }
-    
-    timeval t;
-    vrpn_gettimeofday(&t, NULL);
-    trackerLog << "Reset " << t.tv_sec << " " << t.tv_usec << std::endl;
-
-    victim = NULL;
-}
-
-
-const Vec2& Tracking::GetRoomMin() const {
-    return roomMin;
-}
-
-const Vec2& Tracking::GetRoomMax() const {
-    return roomMax;
-}
-
-
-int Tracking::GetNumberOfViewers() const {
-    return (int)viewers.size();
-}
-
-Viewer* Tracking::GetViewer(int index) const {
-    // XXX : No bounds checking on index is performed
-    return viewers[index];
-}
-
-
-float Tracking::GetAverageDistance(const Vec2& position, int n) const {
-    std::vector<float> distances;
-
-    for (int i = 0; i < (int)viewers.size(); i++) {
-        Vec2 viewerPos = viewers[i]->GetPosition();
-        distances.push_back((viewerPos - position).Magnitude());
-    }
-
-    if (n > 0 && n < (int)viewers.size()) {
-        sort(distances.begin(), distances.end());
-    }
-    else {
-        n = (int)viewers.size();
-    }
-
-    float average = 0.0;
-    for (int i = 0; i < n; i++) {
-        average += distances[i];
-    }
-    average /= n;
-
-    return average;
-}
-
-
-void Tracking::PickVictim() {
-    float maxDistance = -1.0;
-    int victimIndex = -1;
-    victim = NULL;
-    for (int i = 0; i < (int)viewers.size(); i++) {
-        float distance = viewers[i]->GetAverageClosestDistance();
-        if (distance > maxDistance) {
-            maxDistance = distance;
-            victim = viewers[i];
-            victimIndex = i;
-        }
-    }
-
-    trackerLog << "Victim " << victimIndex << std::endl;
-}
-
-Viewer* Tracking::GetVictim() {
-    return victim;
-}
-
-
-void Tracking::SetRoomExtents(const Vec2& min, const Vec2& max) {
-    roomMin = min;
-    roomMax = max;
-
-    for (int i = 0; i < (int)viewers.size(); i++) {
-        viewers[i]->SetWorkspace(roomMin, roomMax);
-    }
-
-    gotWorkspace = true;
-}
-
-void Tracking::UpdateViewer(int index, const Vec3& position, const timeval& time) {
-    // Check for removal
-    if (position.X() < -9.0 && 
-        position.Y() < -9.0 && 
-        position.Z() < -9.0) {
-
-        // DON'T REMOVE DURING VICTIMIZING
-        if (!victim) {
-            // Check for validity
-            if (index >= (int)sensors.size()) return;
-            if (sensors[index] == NULL) return;
-
-            // Find the viewer
-            for (int i = 0; i < (int)viewers.size(); i++) {
-                if (viewers[i] == sensors[index] /* Pointer comparison...*/) {
-                    viewers.erase(viewers.begin() + i);
-
-                    // Put a check here just to be safe...
-                    if (i < (int)avatars->size()) {
-                        delete (*avatars)[i];
-                        avatars->erase(avatars->begin() + i);
-                    }
-
-                    delete sensors[index];
-                    sensors[index] = NULL;
-
-                    // Add to the log
-                    trackerLog << index << " Remove " << time.tv_sec << " " << time.tv_usec << std::endl; 
-
-                    return;
-                }
-            }
-        }
-    }
-
-
-    // Update the sensors, increasing the vector size if necessary
-    if (index >= (int)sensors.size()) {
-        int oldSize = (int)sensors.size();
-        sensors.resize(index + 1);
-
-        // Add NULL pointers for sensors not seen yet
-        for (int i = oldSize; i < index; i++) {
-            sensors[i] = NULL;
-        }
-
-        // Create a new sensor
-        sensors[index] = new Viewer();
-        sensors[index]->SetWorkspace(roomMin, roomMax);
-
-        // Add to the viewers
-        viewers.push_back(sensors[index]);
-    }
-    else if (sensors[index] == NULL) {
-        // Create a new sensor
-        sensors[index] = new Viewer();
-        sensors[index]->SetWorkspace(roomMin, roomMax);
-
-        // Add to the viewers
-        viewers.push_back(sensors[index]);
-    }
-
-
-    // Get closest distance from other viewers
-    if ((int)viewers.size() > 1) {
-        Vec2 p0 = sensors[index]->GetPosition();
-        float closest = 10.0;
-        for (int i = 0; i < (int)sensors.size(); i++) {
-            if (i != index && sensors[i] != NULL) {
-                Vec2 p1 = sensors[i]->GetPosition();
-                float distance = p0.Distance(p1);
-                if (distance < closest) {
-                    closest = distance;
-                }
-            }
-        }
-        sensors[index]->SetCurrentClosestDistance(closest);
-    }
- 
-
-    // Update
-    sensors[index]->Update(position, time);
-
-
-    // Add to the log
-    trackerLog << index << " " << 
-                  position.X() << " " << position.Y() << " " << position.Z() << " " <<
-                  time.tv_sec << " " << time.tv_usec << std::endl; 
-}
-
-/*
-void VRPN_CALLBACK Tracking::HandleWorkspace(void* userData, const vrpn_TRACKERWORKSPACECB w) {
-    Tracking* tracking = static_cast<Tracking*>(userData);
-    tracking->SetRoomExtents(Vec2(w.workspace_min[0], w.workspace_min[1]), 
-                             Vec2(w.workspace_max[0], w.workspace_max[1]));
-}
-*/
-
-void VRPN_CALLBACK Tracking::HandleTracker(void* userData, const vrpn_TRACKERCB t) {
-    Tracking* tracking = static_cast<Tracking*>(userData);
-    tracking->UpdateViewer(t.sensor, 
-                           Vec3(t.pos[0], t.pos[1], t.pos[2]), 
-                           t.msg_time);
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        Tracking.cpp
+//
+// Author:      David Borland
+//
+// Description: Main Tracking of Azrael.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////// 
+
+
+#include "Tracking.h"
+
+#include "ViewerKernels.h"
+
+#include <algorithm>
+
+#include <wx/datetime.h>
+
+
+Tracking::Tracking() : samples(4096) {
+    gotWorkspace = false;
+
+    tracker = NULL;
+    trackerThread = NULL;
+    droppedSamples = 0;
+    replay = NULL;
+    victim = NULL;
+    avatars = NULL;
+}
+
+Tracking::~Tracking() {
+    if (trackerThread) {
+        trackerThread->Stop();
+        trackerThread->Wait();
+        delete trackerThread;
+    }
+
+    if (tracker) delete tracker;
+    if (replay) delete replay;
+
+    trackerLog.Close();
+}
+
+
+bool Tracking::Initialize(std::vector<AzraelImage*>* avatarImages, const std::string& replayFileName) {
+    if (replayFileName != "") {
+        // Replay a tracker log
+        replay = new TrackerReplay();
+        if (!replay->Initialize(replayFileName)) {
+            wxLogMessage("Tracking::Initialize() : Could not load tracker log %s", replayFileName.c_str());
+            return false;
+        }
+    }
+    else {
+        // Initialize VRPN
+        tracker = new vrpn_Tracker_Remote("UbiSense@localhost");
+        tracker->register_change_handler(this, &Tracking::HandleTracker);
+
+        // From here on the tracker is only touched by its thread
+        trackerThread = new TrackerThread(tracker);
+        if (trackerThread->Create() != wxTHREAD_NO_ERROR || trackerThread->Run() != wxTHREAD_NO_ERROR) {
+            wxLogMessage("Tracking::Initialize() : Could not start tracker thread");
+            delete trackerThread;
+            trackerThread = NULL;
+            return false;
+        }
+    }
+
+// This should be how it's done, but it sometimes hangs...
+/*
+    tracker->register_change_handler(this, &Tracking::HandleWorkspace);
+
+    // Get the workspace from the tracker
+    tracker->request_workspace();
+    for (int i = 0; i < 5000; i++) {
+        tracker->mainloop();
+
+        vrpn_SleepMsecs(1);
+
+        if (gotWorkspace) break;
+    }
+    if (!gotWorkspace) {
+        wxLogMessage("Tracking::Initialize() : Could not get workspace from tracker");
+        return false;
+    }   
+*/
+    // ...so just hard code it...
+    SetRoomExtents(Vec2(0.0, 0.0), Vec2(6.5, 6.5));
+
+
+    // Open the tracker log
+    wxDateTime now = wxDateTime::Now();
+    std::string fileName = "Logs/";
+    fileName += now.FormatISODate().c_str();
+    fileName += "_";
+    fileName += now.FormatISOTime().c_str();
+    fileName += ".bin";
+
+    for (int i = 0; i < (int)fileName.size(); i++) {
+        if (fileName[i] == ':') fileName[i] = '-';
+    }
+    trackerLog.Open(fileName);
+
+    // Copy the avatarImages pointer
+    avatars = avatarImages;
+
+    return true;
+}
+
+
+void Tracking::Update(double seconds) {
+    if (replay) {
+        replay->Update(this, seconds);
+        return;
+    }
+
+
+    // Coalesce everything received since the last frame into the latest sample per sensor
+    TrackerSample sample;
+    while (samples.Pop(sample)) {
+        if (sample.index < 0) continue;
+
+        if (sample.index >= (int)latestSamples.size()) {
+            latestSamples.resize(sample.index + 1);
+            haveLatestSample.resize(sample.index + 1, 0);
+        }
+
+        // Only the latest is applied, but the log keeps every sample.  The latest is logged
+        // by UpdateViewer(), after any replaced here.
+        if (haveLatestSample[sample.index]) {
+            const TrackerSample& replaced = latestSamples[sample.index];
+            trackerLog.LogSample(replaced.index, replaced.position, replaced.time);
+        }
+
+        latestSamples[sample.index] = sample;
+        haveLatestSample[sample.index] = 1;
+    }
+
+    for (int i = 0; i < (int)latestSamples.size(); i++) {
+        if (haveLatestSample[i]) {
+            UpdateViewer(i, latestSamples[i].position, latestSamples[i].time);
+            haveLatestSample[i] = 0;
+        }
+    }
+
+
+    // Check for overflow
+    LONG dropped = InterlockedExchange(&droppedSamples, 0);
+    if (dropped > 0) {
+        wxLogMessage("Tracking::Update() : Dropped %d tracker samples", (int)dropped);
+    }
+}
+
+
+void Tracking::Reset() {
+    for (int i = 0; i < (int)viewers.size(); i++) {
+        viewers[i]->Reset();
+    }
+    
+    timeval t;
+    if (replay) {
+        t = replay->GetCurrentTime();
+    }
+    else {
+        vrpn_gettimeofday(&t, NULL);
+    }
+    trackerLog.LogReset(t);
+
+    victim = NULL;
+}
+
+
+bool Tracking::IsReplaying() const {
+    return replay != NULL;
+}
+
+bool Tracking::ReplayFinished() const {
+    return replay && replay->Finished();
+}
+
+
+const Vec2& Tracking::GetRoomMin() const {
+    return roomMin;
+}
+
+const Vec2& Tracking::GetRoomMax() const {
+    return roomMax;
+}
+
+
+int Tracking::GetNumberOfViewers() const {
+    return (int)viewers.size();
+}
+
+Viewer* Tracking::GetViewer(int index) const {
+    // XXX : No bounds checking on index is performed
+    return viewers[index];
+}
+
+
+float Tracking::GetAverageDistance(const Vec2& position, int n) const {
+    float average = 0.0;
+
+    if (n > 0 && n < (int)viewers.size() && n <= ViewerGrid::maxNeighbors) {
+        // Get the n closest from the grid
+        float distances[ViewerGrid::maxNeighbors];
+        n = grid.KNearest(position, n, distances);
+
+        for (int i = 0; i < n; i++) {
+            average += distances[i];
+        }
+    }
+    else if (n > 0 && n < (int)viewers.size()) {
+        // Too many for the grid query
+        std::vector<float> distances;
+
+        for (int i = 0; i < (int)viewers.size(); i++) {
+            Vec2 viewerPos = viewers[i]->GetPosition();
+            distances.push_back((viewerPos - position).Magnitude());
+        }
+
+        std::partial_sort(distances.begin(), distances.begin() + n, distances.end());
+
+        for (int i = 0; i < n; i++) {
+            average += distances[i];
+        }
+    }
+    else {
+        n = (int)viewers.size();
+
+        for (int i = 0; i < n; i++) {
+            Vec2 viewerPos = viewers[i]->GetPosition();
+            average += (viewerPos - position).Magnitude();
+        }
+    }
+
+    average /= n;
+
+    return average;
+}
+
+void Tracking::GetAverageDistances(const std::vector<Vec2>& positions, int n, std::vector<float>& averages) const {
+    averages.resize(positions.size());
+
+    if (positions.empty()) return;
+
+    GetAverageDistances(&positions[0], (int)positions.size(), n, &averages[0], distanceScratch);
+}
+
+void Tracking::GetAverageDistances(const Vec2* positions, int numPositions, int n, float* averages, 
+                                   std::vector<float>& scratch) const {
+    int numViewers = (int)viewers.size();
+
+    if (numViewers == 0) {
+        for (int j = 0; j < numPositions; j++) {
+            averages[j] = GetAverageDistance(positions[j], n);
+        }
+
+        return;
+    }
+
+    if (n == 1 && numViewers > 1) {
+        // Just the closest
+        for (int j = 0; j < numPositions; j++) {
+            averages[j] = ViewerKernels::ClosestDistance(&viewerX[0], &viewerY[0], numViewers, 
+                                                         positions[j].X(), positions[j].Y(), -1, 1.0e10f);
+        }
+
+        return;
+    }
+
+    if ((int)scratch.size() < numViewers) {
+        scratch.resize(numViewers);
+    }
+    float* distances = &scratch[0];
+
+    for (int j = 0; j < numPositions; j++) {
+        ViewerKernels::Distances(&viewerX[0], &viewerY[0], numViewers, 
+                                 positions[j].X(), positions[j].Y(), distances);
+
+        float average = 0.0;
+
+        if (n <= 0 || n >= numViewers) {
+            // Average of all viewers
+            for (int i = 0; i < numViewers; i++) {
+                average += distances[i];
+            }
+            averages[j] = average / numViewers;
+        }
+        else if (n <= ViewerGrid::maxNeighbors) {
+            // Bounded selection of the n closest, kept sorted by insertion
+            float closest[ViewerGrid::maxNeighbors];
+
+            for (int i = 0; i < numViewers; i++) {
+                float distance = distances[i];
+
+                // The first n viewers fill the list, after that only closer ones get in
+                int k;
+                if (i < n) {
+                    k = i;
+                }
+                else if (distance < closest[n - 1]) {
+                    k = n - 1;
+                }
+                else {
+                    continue;
+                }
+
+                while (k > 0 && closest[k - 1] > distance) {
+                    closest[k] = closest[k - 1];
+                    k--;
+                }
+                closest[k] = distance;
+            }
+
+            for (int k = 0; k < n; k++) {
+                average += closest[k];
+            }
+            averages[j] = average / n;
+        }
+        else {
+            std::nth_element(distances, distances + n, distances + numViewers);
+
+            for (int k = 0; k < n; k++) {
+                average += distances[k];
+            }
+            averages[j] = average / n;
+        }
+    }
+}
+
+bool Tracking::IsViewerWithin(const Vec2& position, float radius) const {
+    int index;
+    return grid.WithinRadius(position, radius, &index, 1) > 0;
+}
+
+
+int Tracking::GetNumberOfViewersInQuadrant(int quadrant) const {
+    if ((int)viewers.size() == 0) return 0;
+
+    return ViewerKernels::CountQuadrant(&viewerQuadrants[0], (int)viewers.size(), quadrant);
+}
+
+
+void Tracking::GetWallProjections(std::vector<Vec2>& wallPositions) const {
+    int numViewers = (int)viewers.size();
+
+    wallPositions.resize(numViewers);
+
+    if (numViewers == 0) return;
+
+    if ((int)wallXScratch.size() < numViewers) {
+        wallXScratch.resize(numViewers);
+        wallYScratch.resize(numViewers);
+    }
+
+    // Same room center as Viewer::SetWorkspace()
+    float centerX = (roomMax.X() - roomMin.X()) * 0.5f;
+    float centerY = (roomMax.Y() - roomMin.Y()) * 0.5f;
+
+    ViewerKernels::ProjectToWall(&viewerX[0], &viewerY[0], numViewers,
+                                 centerX, centerY, roomMax.X(), roomMax.Y(),
+                                 &wallXScratch[0], &wallYScratch[0]);
+
+    for (int i = 0; i < numViewers; i++) {
+        wallPositions[i] = Vec2(wallXScratch[i], wallYScratch[i]);
+    }
+}
+
+
+void Tracking::PickVictim() {
+    float maxDistance = -1.0;
+    int victimIndex = -1;
+    victim = NULL;
+    for (int i = 0; i < (int)viewers.size(); i++) {
+        float distance = viewers[i]->GetAverageClosestDistance();
+        if (distance > maxDistance) {
+            maxDistance = distance;
+            victim = viewers[i];
+            victimIndex = i;
+        }
+    }
+
+    trackerLog.LogVictim(victimIndex);
+}
+
+Viewer* Tracking::GetVictim() {
+    return victim;
+}
+
+
+void Tracking::SetRoomExtents(const Vec2& min, const Vec2& max) {
+    roomMin = min;
+    roomMax = max;
+
+    grid.SetExtents(roomMin, roomMax);
+
+    for (int i = 0; i < (int)viewers.size(); i++) {
+        viewers[i]->SetWorkspace(roomMin, roomMax);
+    }
+
+    gotWorkspace = true;
+}
+
+void Tracking::UpdateViewer(int index, const Vec3& position, const timeval& time) {
+    // Check for removal
+    if (position.X() < -9.0 && 
+        position.Y() < -9.0 && 
+        position.Z() < -9.0) {
+
+        // DON'T REMOVE DURING VICTIMIZING
+        if (!victim) {
+            // Check for validity
+            if (index >= (int)sensors.size()) return;
+            if (sensors[index] == NULL) return;
+
+            // Find the viewer
+            int i = sensorSlots[index];
+            if (i >= 0) {
+                RemoveViewer(i);
+
+                // Put a check here just to be safe...
+                if (avatars && i < (int)avatars->size()) {
+                    delete (*avatars)[i];
+                    avatars->erase(avatars->begin() + i);
+                }
+
+                delete sensors[index];
+                sensors[index] = NULL;
+
+                grid.Remove(index);
+
+                // Add to the log
+                trackerLog.LogRemove(index, time);
+
+                return;
+            }
+        }
+    }
+
+
+    // Update the sensors, increasing the vector size if necessary
+    if (index >= (int)sensors.size()) {
+        int oldSize = (int)sensors.size();
+        sensors.resize(index + 1);
+        sensorSlots.resize(index + 1, -1);
+
+        // Add NULL pointers for sensors not seen yet
+        for (int i = oldSize; i < index; i++) {
+            sensors[i] = NULL;
+        }
+
+        // Create a new sensor
+        sensors[index] = new Viewer();
+        sensors[index]->SetWorkspace(roomMin, roomMax);
+
+        // Add to the viewers
+        AddViewer(index);
+    }
+    else if (sensors[index] == NULL) {
+        // Create a new sensor
+        sensors[index] = new Viewer();
+        sensors[index]->SetWorkspace(roomMin, roomMax);
+
+        // Add to the viewers
+        AddViewer(index);
+    }
+
+
+    // Get closest distance from other viewers
+    if ((int)viewers.size() > 1) {
+        float closest = 10.0;
+        float distance;
+        if (grid.KNearest(sensors[index]->GetPosition(), 1, &distance, index) > 0 && distance < closest) {
+            closest = distance;
+        }
+        sensors[index]->SetCurrentClosestDistance(closest);
+    }
+ 
+
+    // Update
+    sensors[index]->Update(position, time);
+    grid.Move(index, sensors[index]->GetPosition());
+
+    int slot = sensorSlots[index];
+    viewerX[slot] = sensors[index]->GetPosition().X();
+    viewerY[slot] = sensors[index]->GetPosition().Y();
+    viewerZ[slot] = sensors[index]->GetPosition().Z();
+    viewerQuadrants[slot] = sensors[index]->GetQuadrant();
+
+
+    // Add to the log
+    trackerLog.LogSample(index, position, time);
+}
+
+
+void Tracking::AddViewer(int index) {
+    sensorSlots[index] = (int)viewers.size();
+
+    viewers.push_back(sensors[index]);
+
+    const Vec3& p = sensors[index]->GetPosition();
+    viewerX.push_back(p.X());
+    viewerY.push_back(p.Y());
+    viewerZ.push_back(p.Z());
+    viewerQuadrants.push_back(sensors[index]->GetQuadrant());
+
+    grid.Insert(index, p);
+}
+
+void Tracking::RemoveViewer(int slot) {
+    // Keep the same order as viewers, as the avatars are matched by index
+    viewers.erase(viewers.begin() + slot);
+    viewerX.erase(viewerX.begin() + slot);
+    viewerY.erase(viewerY.begin() + slot);
+    viewerZ.erase(viewerZ.begin() + slot);
+    viewerQuadrants.erase(viewerQuadrants.begin() + slot);
+
+    for (int i = 0; i < (int)sensorSlots.size(); i++) {
+        if (sensorSlots[i] == slot) sensorSlots[i] = -1;
+        else if (sensorSlots[i] > slot) sensorSlots[i]--;
+    }
+}
+
+
+/*
+void VRPN_CALLBACK Tracking::HandleWorkspace(void* userData, const vrpn_TRACKERWORKSPACECB w) {
+    Tracking* tracking = static_cast<Tracking*>(userData);
+    tracking->SetRoomExtents(Vec2(w.workspace_min[0], w.workspace_min[1]), 
+                             Vec2(w.workspace_max[0], w.workspace_max[1]));
+}
+*/
+
+void VRPN_CALLBACK Tracking::HandleTracker(void* userData, const vrpn_TRACKERCB t) {
+    // Called on the tracker thread, so just pass the sample on to Update()
+    Tracking* tracking = static_cast<Tracking*>(userData);
+
+    TrackerSample sample;
+    sample.index = t.sensor;
+    sample.position = Vec3(t.pos[0], t.pos[1], t.pos[2]);
+    sample.time = t.msg_time;
+
+    if (!tracking->samples.Push(sample)) {
+        InterlockedIncrement(&tracking->droppedSamples);
+    }
 }
\ No newline at end of file
@@ -1,79 +1,142 @@
-///////////////////////////////////////////////////////////////////////////////////////////////
-//
-// Name:        Tracking.h
-//
-// Author:      David Borland
-//
-// Description: Handles viewer tracking for Azrael.
-//
-/////////////////////////////////////////////////////////////////////////////////////////////// 
-
-
-#ifndef TRACKING_H
-#define TRACKING_H
-
-
-#include <vector>
-
-#include <wx/log.h>     // This must be included before Video.h
-
-#include <fstream>
-
-#include <vrpn_Tracker.h>
-
-#include "Viewer.h"
-#include "AzraelImage.h"
-
-
-class Tracking {
-public:
-    Tracking();
-    ~Tracking();
-
-    bool Initialize(std::vector<AzraelImage*>* avatarImages);
-
-    void Update();
-
-    void Reset();
-
-    const Vec2& GetRoomMin() const;
-    const Vec2& GetRoomMax() const;
-
-    int GetNumberOfViewers() const;
-
-    Viewer* GetViewer(int index) const;
-
-    // Computes the average distance of the viewers from a position.  If n > 0,
-    // returns the average distance of the n closest viewers
-    float GetAverageDistance(const Vec2& position, int n = -1) const;
-
-    void PickVictim();
-    Viewer* GetVictim();
-
-    // Called from vrpn callbacks
-    void SetRoomExtents(const Vec2& min, const Vec2& max);
-    void UpdateViewer(int index, const Vec3& position, const timeval& time);
-
-private:
-    std::vector<Viewer*> sensors;   // The index here relates directly to the Tracker sensor in vrpn
-    std::vector<Viewer*> viewers;   // Pointers to the potentialViewers that are active
-    Viewer* victim;
-
-    std::vector<AzraelImage*>* avatars;
-
-    vrpn_Tracker_Remote* tracker;
-
-    Vec2 roomMin;
-    Vec2 roomMax;
-
-    bool gotWorkspace;
-
-    std::fstream trackerLog;
-
-    // Vrpn callbacks
-//    static void VRPN_CALLBACK HandleWorkspace(void* userData, const vrpn_TRACKERWORKSPACECB w);
-    static void VRPN_CALLBACK HandleTracker(void* userData, const vrpn_TRACKERCB t); 
-};
-
-
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        Tracking.h
+//
+// Author:      David Borland
+//
+// Description: Handles viewer tracking for Azrael.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////// 
+
+
+#ifndef TRACKING_H
+#define TRACKING_H
+
+
+#include <vector>
+#include <string>
+
+#include <wx/log.h>     // This must be included before Video.h
+
+#include <vrpn_Tracker.h>
+
+#include "Viewer.h"
+#include "AzraelImage.h"
+#include "TrackerReplay.h"
+#include "ViewerGrid.h"
+#include "TrackerThread.h"
+#include "RingBuffer.h"
+#include "TrackerLogger.h"
+
+
+class Tracking {
+public:
+    Tracking();
+    ~Tracking();
+
+    // If replayFileName is given, samples are read from that tracker log instead of vrpn
+    bool Initialize(std::vector<AzraelImage*>* avatarImages, const std::string& replayFileName = "");
+
+    // When replaying, advances the replay by the given number of seconds
+    void Update(double seconds);
+
+    void Reset();
+
+    bool IsReplaying() const;
+    bool ReplayFinished() const;
+
+    const Vec2& GetRoomMin() const;
+    const Vec2& GetRoomMax() const;
+
+    int GetNumberOfViewers() const;
+
+    Viewer* GetViewer(int index) const;
+
+    // Computes the average distance of the viewers from a position.  If n > 0,
+    // returns the average distance of the n closest viewers
+    float GetAverageDistance(const Vec2& position, int n = -1) const;
+
+    // Batched version of GetAverageDistance.  Computes the average distance of the n closest
+    // viewers for every position using the SSE kernels, without allocating once the scratch 
+    // buffer has grown to size.
+    void GetAverageDistances(const std::vector<Vec2>& positions, int n, std::vector<float>& averages) const;
+
+    // Same as above for count positions, using the given scratch buffer instead of the 
+    // shared one, so separate threads can work on separate ranges at once
+    void GetAverageDistances(const Vec2* positions, int count, int n, float* averages, 
+                             std::vector<float>& scratch) const;
+
+    // Returns true if any viewer is closer than radius to the position
+    bool IsViewerWithin(const Vec2& position, float radius) const;
+
+    int GetNumberOfViewersInQuadrant(int quadrant) const;
+
+    // Projects all viewers onto the walls at once.  Same order as GetViewer().
+    void GetWallProjections(std::vector<Vec2>& wallPositions) const;
+
+    void PickVictim();
+    Viewer* GetVictim();
+
+    // Called when samples are drained in Update(), or from the replay
+    void SetRoomExtents(const Vec2& min, const Vec2& max);
+    void UpdateViewer(int index, const Vec3& position, const timeval& time);
+
+private:
+    std::vector<Viewer*> sensors;   // The index here relates directly to the Tracker sensor in vrpn
+    std::vector<Viewer*> viewers;   // Pointers to the potentialViewers that are active
+    Viewer* victim;
+
+    // Spatial index of the sensor positions, used for the proximity queries
+    ViewerGrid grid;
+
+    // Structure-of-arrays copy of the viewer data used by the SSE kernels, in the same 
+    // order as viewers
+    std::vector<float> viewerX;
+    std::vector<float> viewerY;
+    std::vector<float> viewerZ;
+    std::vector<int> viewerQuadrants;
+
+    // Index into viewers for each sensor, or -1
+    std::vector<int> sensorSlots;
+
+    // Scratch buffers for GetAverageDistances() and GetWallProjections()
+    mutable std::vector<float> distanceScratch;
+    mutable std::vector<float> wallXScratch;
+    mutable std::vector<float> wallYScratch;
+
+    void AddViewer(int index);
+    void RemoveViewer(int slot);
+
+    std::vector<AzraelImage*>* avatars;
+
+    vrpn_Tracker_Remote* tracker;
+    TrackerThread* trackerThread;
+    TrackerReplay* replay;
+
+    // Samples passed from the tracker thread to Update()
+    struct TrackerSample {
+        int index;
+        Vec3 position;
+        timeval time;
+    };
+    RingBuffer<TrackerSample> samples;
+    volatile LONG droppedSamples;
+
+    // Latest sample for each sensor received since the last Update()
+    std::vector<TrackerSample> latestSamples;
+    std::vector<char> haveLatestSample;
+
+    Vec2 roomMin;
+    Vec2 roomMax;
+
+    bool gotWorkspace;
+
+    TrackerLogger trackerLog;
+
+    // Vrpn callbacks
+//    static void VRPN_CALLBACK HandleWorkspace(void* userData, const vrpn_TRACKERWORKSPACECB w);
+    static void VRPN_CALLBACK HandleTracker(void* userData, const vrpn_TRACKERCB t); 
+};
+
+
 #endif
\ No newline at end of file
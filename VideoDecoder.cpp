@@ -0,0 +1,138 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        VideoDecoder.cpp
+//
+// Author:      David Borland
+//
+// Description: Decodes playing videos on a few worker threads, so decoding doesn't happen in
+//              the update.  Each video is decoded at most once per decode interval, by
+//              whichever thread gets to it first, into the video's queue of frames.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "VideoDecoder.h"
+
+#include <wx/log.h>
+
+
+const int VideoDecoder::decodeInterval = 10;
+
+
+VideoDecoder::VideoDecoder() {
+    LARGE_INTEGER f;
+    QueryPerformanceFrequency(&f);
+    frequency = f.QuadPart;
+
+    interval = frequency * decodeInterval / 1000;
+}
+
+VideoDecoder::~VideoDecoder() {
+    Stop();
+}
+
+
+void VideoDecoder::Add(AzraelVideo* video) {
+    Entry entry;
+    entry.video = video;
+    entry.nextDecode = 0;
+    entry.claimed = 0;
+
+    entries.push_back(entry);
+}
+
+
+bool VideoDecoder::Start(int numberOfThreads) {
+    // Updates stop decoding these themselves
+    for (int i = 0; i < (int)entries.size(); i++) {
+        entries[i].video->SetDecodeThread(true);
+    }
+
+    for (int i = 0; i < numberOfThreads; i++) {
+        VideoDecoderThread* thread = new VideoDecoderThread(this);
+
+        if (thread->Create() != wxTHREAD_NO_ERROR || thread->Run() != wxTHREAD_NO_ERROR) {
+            wxLogMessage("VideoDecoder::Start() : Couldn't start decode thread");
+            delete thread;
+            Stop();
+            return false;
+        }
+
+        threads.push_back(thread);
+    }
+
+    return true;
+}
+
+void VideoDecoder::Stop() {
+    for (int i = 0; i < (int)threads.size(); i++) {
+        threads[i]->Stop();
+    }
+
+    for (int i = 0; i < (int)threads.size(); i++) {
+        threads[i]->Wait();
+        delete threads[i];
+    }
+
+    threads.clear();
+
+    // Back to decoding in the update
+    for (int i = 0; i < (int)entries.size(); i++) {
+        entries[i].video->SetDecodeThread(false);
+    }
+}
+
+
+int VideoDecoder::GetNumberOfThreads() const {
+    return (int)threads.size();
+}
+
+
+bool VideoDecoder::DecodeDue() {
+    LARGE_INTEGER t;
+    QueryPerformanceCounter(&t);
+    LONGLONG now = t.QuadPart;
+
+    bool decoded = false;
+
+    for (int i = 0; i < (int)entries.size(); i++) {
+        Entry& entry = entries[i];
+
+        if (now < entry.nextDecode) continue;
+
+        // Another thread has it
+        if (InterlockedCompareExchange(&entry.claimed, 1, 0) != 0) continue;
+
+        // Check again, now that only this thread can change it
+        if (now >= entry.nextDecode) {
+            entry.nextDecode = now + interval;
+
+            if (entry.video->Decode()) decoded = true;
+        }
+
+        InterlockedExchange(&entry.claimed, 0);
+    }
+
+    return decoded;
+}
+
+
+VideoDecoderThread::VideoDecoderThread(VideoDecoder* videoDecoder) : wxThread(wxTHREAD_JOINABLE) {
+    decoder = videoDecoder;
+
+    stop = false;
+}
+
+
+wxThread::ExitCode VideoDecoderThread::Entry() {
+    while (!stop && !TestDestroy()) {
+        if (!decoder->DecodeDue()) Sleep(1);
+    }
+
+    return 0;
+}
+
+
+void VideoDecoderThread::Stop() {
+    stop = true;
+}
\ No newline at end of file
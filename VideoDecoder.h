@@ -0,0 +1,85 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        VideoDecoder.h
+//
+// Author:      David Borland
+//
+// Description: Decodes playing videos on a few worker threads, so decoding doesn't happen in
+//              the update.  Each video is decoded at most once per decode interval, by
+//              whichever thread gets to it first, into the video's queue of frames.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef VIDEODECODER_H
+#define VIDEODECODER_H
+
+
+#include <windows.h>
+
+#include <wx/thread.h>
+
+#include <vector>
+
+#include "AzraelVideo.h"
+
+
+class VideoDecoderThread;
+
+
+class VideoDecoder {
+public:
+    VideoDecoder();
+    ~VideoDecoder();
+
+    // Add all videos before Start()
+    void Add(AzraelVideo* video);
+
+    bool Start(int numberOfThreads = 2);
+    void Stop();
+
+    int GetNumberOfThreads() const;
+
+private:
+    friend class VideoDecoderThread;
+
+    struct Entry {
+        AzraelVideo* video;
+        LONGLONG nextDecode;
+
+        // Set by the thread decoding it
+        volatile LONG claimed;
+    };
+
+    std::vector<Entry> entries;
+
+    std::vector<VideoDecoderThread*> threads;
+
+    LONGLONG frequency;
+    LONGLONG interval;
+
+    // Milliseconds between decodes of the same video, matching the update rate
+    static const int decodeInterval;
+
+    // Called from the threads.  Returns whether anything was decoded.
+    bool DecodeDue();
+};
+
+
+class VideoDecoderThread : public wxThread {
+public:
+    VideoDecoderThread(VideoDecoder* videoDecoder);
+
+    virtual ExitCode Entry();
+
+    // Ask the thread to finish.  Call Wait() afterwards.
+    void Stop();
+
+private:
+    VideoDecoder* decoder;
+
+    volatile bool stop;
+};
+
+
+#endif
\ No newline at end of file
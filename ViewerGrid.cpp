@@ -0,0 +1,226 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        ViewerGrid.cpp
+//
+// Author:      David Borland
+//
+// Description: Uniform grid over the room for answering nearest neighbour and radius 
+//              queries on viewer positions without scanning every viewer.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "ViewerGrid.h"
+
+
+ViewerGrid::ViewerGrid() {
+    cellSize = 1.0;
+    numColumns = numRows = 1;
+    numEntries = 0;
+
+    cellHead.resize(1, -1);
+}
+
+ViewerGrid::~ViewerGrid() {
+}
+
+
+void ViewerGrid::SetExtents(const Vec2& min, const Vec2& max, float gridCellSize) {
+    gridMin = min;
+    cellSize = gridCellSize;
+
+    numColumns = (int)((max.X() - min.X()) / cellSize) + 1;
+    numRows = (int)((max.Y() - min.Y()) / cellSize) + 1;
+
+    if (numColumns < 1) numColumns = 1;
+    if (numRows < 1) numRows = 1;
+
+    cellHead.assign(numColumns * numRows, -1);
+
+    // Re-bin everything currently in the grid
+    for (int i = 0; i < (int)cell.size(); i++) {
+        if (cell[i] >= 0) {
+            int column, row;
+            GetCell(positions[i], column, row);
+
+            cell[i] = -1;
+            Link(i, row * numColumns + column);
+        }
+    }
+}
+
+
+void ViewerGrid::Insert(int index, const Vec2& position) {
+    if (index < 0) return;
+
+    if (index >= (int)cell.size()) {
+        cell.resize(index + 1, -1);
+        next.resize(index + 1, -1);
+        previous.resize(index + 1, -1);
+        positions.resize(index + 1);
+    }
+
+    if (cell[index] >= 0) {
+        Move(index, position);
+        return;
+    }
+
+    positions[index] = position;
+
+    int column, row;
+    GetCell(position, column, row);
+    Link(index, row * numColumns + column);
+
+    numEntries++;
+}
+
+void ViewerGrid::Move(int index, const Vec2& position) {
+    if (index < 0 || index >= (int)cell.size() || cell[index] < 0) {
+        Insert(index, position);
+        return;
+    }
+
+    positions[index] = position;
+
+    int column, row;
+    GetCell(position, column, row);
+    int cellIndex = row * numColumns + column;
+
+    // Only relink if the entry changed cells
+    if (cellIndex != cell[index]) {
+        Unlink(index);
+        Link(index, cellIndex);
+    }
+}
+
+void ViewerGrid::Remove(int index) {
+    if (index < 0 || index >= (int)cell.size() || cell[index] < 0) return;
+
+    Unlink(index);
+
+    numEntries--;
+}
+
+void ViewerGrid::Clear() {
+    cellHead.assign(numColumns * numRows, -1);
+
+    cell.clear();
+    next.clear();
+    previous.clear();
+    positions.clear();
+
+    numEntries = 0;
+}
+
+
+int ViewerGrid::GetNumberOfEntries() const {
+    return numEntries;
+}
+
+
+int ViewerGrid::KNearest(const Vec2& position, int k, float* distances, int exclude) const {
+    if (k > maxNeighbors) k = maxNeighbors;
+    if (k <= 0) return 0;
+
+    int column, row;
+    GetCell(position, column, row);
+
+    int maxRing = numColumns > numRows ? numColumns : numRows;
+
+    // Search rings of cells around the query cell, keeping the k closest sorted by insertion
+    int found = 0;
+    for (int ring = 0; ring <= maxRing; ring++) {
+        for (int r = row - ring; r <= row + ring; r++) {
+            if (r < 0 || r >= numRows) continue;
+
+            // Only the border of the ring, the inside has already been searched
+            int step = (r == row - ring || r == row + ring) ? 1 : 2 * ring;
+            if (step == 0) step = 1;
+
+            for (int c = column - ring; c <= column + ring; c += step) {
+                if (c < 0 || c >= numColumns) continue;
+
+                for (int i = cellHead[r * numColumns + c]; i >= 0; i = next[i]) {
+                    if (i == exclude) continue;
+
+                    float distance = (positions[i] - position).Magnitude();
+
+                    if (found == k && distance >= distances[k - 1]) continue;
+
+                    int j = found < k ? found++ : k - 1;
+                    while (j > 0 && distances[j - 1] > distance) {
+                        distances[j] = distances[j - 1];
+                        j--;
+                    }
+                    distances[j] = distance;
+                }
+            }
+        }
+
+        // Anything in the next ring is at least this far away
+        if (found == k && distances[k - 1] <= ring * cellSize) break;
+    }
+
+    return found;
+}
+
+
+int ViewerGrid::WithinRadius(const Vec2& position, float radius, int* indices, int maxIndices, int exclude) const {
+    int minColumn, minRow, maxColumn, maxRow;
+    GetCell(Vec2(position.X() - radius, position.Y() - radius), minColumn, minRow);
+    GetCell(Vec2(position.X() + radius, position.Y() + radius), maxColumn, maxRow);
+
+    int found = 0;
+    for (int r = minRow; r <= maxRow; r++) {
+        for (int c = minColumn; c <= maxColumn; c++) {
+            for (int i = cellHead[r * numColumns + c]; i >= 0; i = next[i]) {
+                if (i == exclude) continue;
+
+                if ((positions[i] - position).Magnitude() < radius) {
+                    if (found < maxIndices) indices[found] = i;
+                    found++;
+                }
+            }
+        }
+    }
+
+    return found;
+}
+
+
+void ViewerGrid::GetCell(const Vec2& position, int& column, int& row) const {
+    // Clamp to the grid, as tracked positions can be slightly outside the room
+    column = (int)((position.X() - gridMin.X()) / cellSize);
+    row = (int)((position.Y() - gridMin.Y()) / cellSize);
+
+    if (column < 0) column = 0;
+    else if (column >= numColumns) column = numColumns - 1;
+
+    if (row < 0) row = 0;
+    else if (row >= numRows) row = numRows - 1;
+}
+
+
+void ViewerGrid::Link(int index, int cellIndex) {
+    cell[index] = cellIndex;
+    previous[index] = -1;
+    next[index] = cellHead[cellIndex];
+
+    if (next[index] >= 0) previous[next[index]] = index;
+
+    cellHead[cellIndex] = index;
+}
+
+void ViewerGrid::Unlink(int index) {
+    if (previous[index] >= 0) {
+        next[previous[index]] = next[index];
+    }
+    else {
+        cellHead[cell[index]] = next[index];
+    }
+
+    if (next[index] >= 0) previous[next[index]] = previous[index];
+
+    cell[index] = -1;
+    next[index] = previous[index] = -1;
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        ViewerGrid.h
+//
+// Author:      David Borland
+//
+// Description: Uniform grid over the room for answering nearest neighbour and radius 
+//              queries on viewer positions without scanning every viewer.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef VIEWERGRID_H
+#define VIEWERGRID_H
+
+
+#include <vector>
+
+#include <Vec2.h>
+
+
+class ViewerGrid {
+public:
+    ViewerGrid();
+    ~ViewerGrid();
+
+    void SetExtents(const Vec2& min, const Vec2& max, float gridCellSize = 0.5f);
+
+    // Indices are the tracker sensor indices
+    void Insert(int index, const Vec2& position);
+    void Move(int index, const Vec2& position);
+    void Remove(int index);
+    void Clear();
+
+    int GetNumberOfEntries() const;
+
+    // Finds the distances to the k closest entries, in increasing order, ignoring the entry 
+    // with index exclude.  distances must have room for k values, and k is clamped to 
+    // maxNeighbors.  Returns the number of distances found.
+    int KNearest(const Vec2& position, int k, float* distances, int exclude = -1) const;
+
+    // Finds entries closer than radius, ignoring the entry with index exclude.  Up to 
+    // maxIndices indices are written to indices.  Returns the number of entries found.
+    int WithinRadius(const Vec2& position, float radius, int* indices, int maxIndices, int exclude = -1) const;
+
+    static const int maxNeighbors = 16;
+
+private:
+    Vec2 gridMin;
+    float cellSize;
+    int numColumns;
+    int numRows;
+
+    // First entry in each cell, or -1 if empty
+    std::vector<int> cellHead;
+
+    // Per entry, indexed by sensor index.  Entries in the same cell form a doubly linked list.
+    std::vector<int> cell;
+    std::vector<int> next;
+    std::vector<int> previous;
+    std::vector<Vec2> positions;
+
+    int numEntries;
+
+    void GetCell(const Vec2& position, int& column, int& row) const;
+
+    void Link(int index, int cellIndex);
+    void Unlink(int index);
+};
+
+
+#endif
\ No newline at end of file
@@ -0,0 +1,154 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        ViewerKernels.cpp
+//
+// Author:      David Borland
+//
+// Description: SSE kernels operating on all viewers at once, using the structure-of-arrays
+//              viewer positions kept by Tracking.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "ViewerKernels.h"
+
+#include <math.h>
+
+#include <emmintrin.h>
+
+
+void ViewerKernels::Distances(const float* x, const float* y, int count, 
+                              float px, float py, float* distances) {
+    __m128 qx = _mm_set1_ps(px);
+    __m128 qy = _mm_set1_ps(py);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(x + i), qx);
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(y + i), qy);
+        __m128 d2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+        _mm_storeu_ps(distances + i, _mm_sqrt_ps(d2));
+    }
+
+    // Leftovers
+    for (; i < count; i++) {
+        float dx = x[i] - px;
+        float dy = y[i] - py;
+        distances[i] = sqrtf(dx * dx + dy * dy);
+    }
+}
+
+
+float ViewerKernels::ClosestDistance(const float* x, const float* y, int count, 
+                                     float px, float py, int exclude, float maxDistance) {
+    __m128 qx = _mm_set1_ps(px);
+    __m128 qy = _mm_set1_ps(py);
+    __m128 closest = _mm_set1_ps(maxDistance * maxDistance);
+
+    // Compare squared distances, and take the square root once at the end
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(x + i), qx);
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(y + i), qy);
+        __m128 d2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+
+        if (exclude >= i && exclude < i + 4) {
+            // Push the excluded viewer out of range
+            float values[4];
+            _mm_storeu_ps(values, d2);
+            values[exclude - i] = maxDistance * maxDistance;
+            d2 = _mm_loadu_ps(values);
+        }
+
+        closest = _mm_min_ps(closest, d2);
+    }
+
+    float values[4];
+    _mm_storeu_ps(values, closest);
+    float result = values[0];
+    for (int j = 1; j < 4; j++) {
+        if (values[j] < result) result = values[j];
+    }
+
+    // Leftovers
+    for (; i < count; i++) {
+        if (i == exclude) continue;
+
+        float dx = x[i] - px;
+        float dy = y[i] - py;
+        float d2 = dx * dx + dy * dy;
+        if (d2 < result) result = d2;
+    }
+
+    return sqrtf(result);
+}
+
+
+int ViewerKernels::CountQuadrant(const int* quadrants, int count, int quadrant) {
+    __m128i q = _mm_set1_epi32(quadrant);
+    __m128i sum = _mm_setzero_si128();
+
+    // Matches compare to -1, so subtracting counts them
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i values = _mm_loadu_si128((const __m128i*)(quadrants + i));
+        sum = _mm_sub_epi32(sum, _mm_cmpeq_epi32(values, q));
+    }
+
+    int counts[4];
+    _mm_storeu_si128((__m128i*)counts, sum);
+    int result = counts[0] + counts[1] + counts[2] + counts[3];
+
+    // Leftovers
+    for (; i < count; i++) {
+        if (quadrants[i] == quadrant) result++;
+    }
+
+    return result;
+}
+
+
+void ViewerKernels::ProjectToWall(const float* x, const float* y, int count,
+                                  float centerX, float centerY, float maxX, float maxY,
+                                  float* wallX, float* wallY) {
+    __m128 cx = _mm_set1_ps(centerX);
+    __m128 cy = _mm_set1_ps(centerY);
+    __m128 mx = _mm_set1_ps(maxX);
+    __m128 my = _mm_set1_ps(maxY);
+    __m128 zero = _mm_setzero_ps();
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 px = _mm_loadu_ps(x + i);
+        __m128 py = _mm_loadu_ps(y + i);
+        __m128 dx = _mm_sub_ps(px, cx);
+        __m128 dy = _mm_sub_ps(py, cy);
+
+        // Horizontal wall if |dy| > |dx|, otherwise vertical wall
+        __m128 absX = _mm_max_ps(dx, _mm_sub_ps(zero, dx));
+        __m128 absY = _mm_max_ps(dy, _mm_sub_ps(zero, dy));
+        __m128 horizontal = _mm_cmpgt_ps(absY, absX);
+
+        // Wall 0 or 2, and wall 1 or 3
+        __m128 wy = _mm_and_ps(_mm_cmpgt_ps(dy, zero), my);
+        __m128 wx = _mm_and_ps(_mm_cmpgt_ps(dx, zero), mx);
+
+        _mm_storeu_ps(wallX + i, _mm_or_ps(_mm_and_ps(horizontal, px), _mm_andnot_ps(horizontal, wx)));
+        _mm_storeu_ps(wallY + i, _mm_or_ps(_mm_and_ps(horizontal, wy), _mm_andnot_ps(horizontal, py)));
+    }
+
+    // Leftovers
+    for (; i < count; i++) {
+        float dx = x[i] - centerX;
+        float dy = y[i] - centerY;
+
+        if (fabs(dy) > fabs(dx)) {
+            wallX[i] = x[i];
+            wallY[i] = dy > 0 ? maxY : 0.0f;
+        }
+        else {
+            wallX[i] = dx > 0 ? maxX : 0.0f;
+            wallY[i] = y[i];
+        }
+    }
+}
\ No newline at end of file
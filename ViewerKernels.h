@@ -0,0 +1,38 @@
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        ViewerKernels.h
+//
+// Author:      David Borland
+//
+// Description: SSE kernels operating on all viewers at once, using the structure-of-arrays
+//              viewer positions kept by Tracking.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef VIEWERKERNELS_H
+#define VIEWERKERNELS_H
+
+
+class ViewerKernels {
+public:
+    // Writes the distance from (px, py) to each viewer into distances
+    static void Distances(const float* x, const float* y, int count, 
+                          float px, float py, float* distances);
+
+    // Returns the closest distance from (px, py) to any viewer other than exclude, or 
+    // maxDistance if there is none closer
+    static float ClosestDistance(const float* x, const float* y, int count, 
+                                 float px, float py, int exclude, float maxDistance);
+
+    // Returns the number of viewers in the given quadrant
+    static int CountQuadrant(const int* quadrants, int count, int quadrant);
+
+    // Projects each viewer onto the closest wall, as in Viewer::ProjectToWall()
+    static void ProjectToWall(const float* x, const float* y, int count,
+                              float centerX, float centerY, float maxX, float maxY,
+                              float* wallX, float* wallY);
+};
+
+
+#endif
\ No newline at end of file
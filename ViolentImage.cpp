@@ -1,30 +1,43 @@
-///////////////////////////////////////////////////////////////////////////////////////////////
-//
-// Name:        ViolentImage.cpp
-//
-// Author:      David Borland
-//
-// Description: Violent imagery.
-//
-///////////////////////////////////////////////////////////////////////////////////////////////
-
-
-#include "ViolentImage.h"
-
-
-ViolentImage::ViolentImage() : AzraelImage() {
-    blurRadius = 0;
-    actualBlurRadius = 0;
-}
-
-
-void ViolentImage::UpdateDistance(float distance) {
-    if (distance < 1.5) {
-        scale = 0.5;
-        desiredScale = (float)scale;
-    }
-    else {
-        scale = 0.05;
-        desiredScale = (float)scale;
-    }
-}
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        ViolentImage.cpp
+//
+// Author:      David Borland
+//
+// Description: Violent imagery.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "ViolentImage.h"
+
+
+ViolentImage::ViolentImage() : AzraelImage() {
+    blurRadius = 0;
+    actualBlurRadius = 0;
+}
+
+
+ViolentImage::Type ViolentImage::GetType() const {
+    return Violent;
+}
+
+
+void ViolentImage::Reset() {
+    AzraelImage::Reset();
+
+    blurRadius = 0;
+    actualBlurRadius = 0;
+}
+
+
+void ViolentImage::UpdateDistance(float distance) {
+    if (distance < 1.5) {
+        scale = 0.5;
+        desiredScale = (float)scale;
+    }
+    else {
+        scale = 0.05;
+        desiredScale = (float)scale;
+    }
+}
\ No newline at end of file
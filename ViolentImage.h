@@ -1,27 +1,30 @@
-///////////////////////////////////////////////////////////////////////////////////////////////
-//
-// Name:        ViolentImage.h
-//
-// Author:      David Borland
-//
-// Description: Violent imagery
-//
-/////////////////////////////////////////////////////////////////////////////////////////////// 
-
-
-#ifndef VIOLENTIMAGE_H
-#define VIOLENTIMAGE_H
-
-
-#include "AzraelImage.h"
-
-
-class ViolentImage : public AzraelImage {
-public:    
-    ViolentImage();
-
-    virtual void UpdateDistance(float distance);
-};
-
-
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:        ViolentImage.h
+//
+// Author:      David Borland
+//
+// Description: Violent imagery
+//
+/////////////////////////////////////////////////////////////////////////////////////////////// 
+
+
+#ifndef VIOLENTIMAGE_H
+#define VIOLENTIMAGE_H
+
+
+#include "AzraelImage.h"
+
+
+class ViolentImage : public AzraelImage {
+public:    
+    ViolentImage();
+
+    virtual Type GetType() const;
+    virtual void Reset();
+
+    virtual void UpdateDistance(float distance);
+};
+
+
 #endif
\ No newline at end of file
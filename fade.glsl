@@ -1,21 +1,23 @@
-uniform sampler2DRect image;
-uniform float opacity;
-uniform int shift;
-
-void main() {	
-	int row = gl_FragCoord.y;
-
-	int s;
-	if (row % 2 == 0) {
-		s = shift;
-	}
-	else {
-		s = -shift;
-	}
-
-	vec4 color = texture2DRect(image, vec2(gl_TexCoord[0].s + s, gl_TexCoord[0].t));
-
-	color.a *= opacity;
-		
-	gl_FragColor = color;
+uniform sampler2DRect image;
+
+// Shift and opacity come in per vertex, so images can be drawn together
+void main() {	
+	int shift = int(gl_TexCoord[1].s + 0.5);
+	float opacity = gl_TexCoord[1].t;
+
+	int row = gl_FragCoord.y;
+
+	int s;
+	if (row % 2 == 0) {
+		s = shift;
+	}
+	else {
+		s = -shift;
+	}
+
+	vec4 color = texture2DRect(image, vec2(gl_TexCoord[0].s + s, gl_TexCoord[0].t));
+
+	color.a *= opacity;
+		
+	gl_FragColor = color;
 }
\ No newline at end of file